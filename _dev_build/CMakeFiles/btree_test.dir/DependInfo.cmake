@@ -0,0 +1,32 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/test_deque.cpp" "CMakeFiles/btree_test.dir/tests/test_deque.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_deque.cpp.o.d"
+  "/root/repo/tests/test_inverted_index.cpp" "CMakeFiles/btree_test.dir/tests/test_inverted_index.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_inverted_index.cpp.o.d"
+  "/root/repo/tests/test_iterator_insert_erase.cpp" "CMakeFiles/btree_test.dir/tests/test_iterator_insert_erase.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_iterator_insert_erase.cpp.o.d"
+  "/root/repo/tests/test_iterators.cpp" "CMakeFiles/btree_test.dir/tests/test_iterators.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_iterators.cpp.o.d"
+  "/root/repo/tests/test_min.cpp" "CMakeFiles/btree_test.dir/tests/test_min.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_min.cpp.o.d"
+  "/root/repo/tests/test_ordered.cpp" "CMakeFiles/btree_test.dir/tests/test_ordered.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_ordered.cpp.o.d"
+  "/root/repo/tests/test_random_modifications_indexed.cpp" "CMakeFiles/btree_test.dir/tests/test_random_modifications_indexed.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_random_modifications_indexed.cpp.o.d"
+  "/root/repo/tests/test_random_modifications_ordered.cpp" "CMakeFiles/btree_test.dir/tests/test_random_modifications_ordered.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_random_modifications_ordered.cpp.o.d"
+  "/root/repo/tests/test_reference_wrapper.cpp" "CMakeFiles/btree_test.dir/tests/test_reference_wrapper.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_reference_wrapper.cpp.o.d"
+  "/root/repo/tests/test_sum_lower_bound.cpp" "CMakeFiles/btree_test.dir/tests/test_sum_lower_bound.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_sum_lower_bound.cpp.o.d"
+  "/root/repo/tests/test_summed_indexed.cpp" "CMakeFiles/btree_test.dir/tests/test_summed_indexed.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_summed_indexed.cpp.o.d"
+  "/root/repo/tests/test_uninitialized_array.cpp" "CMakeFiles/btree_test.dir/tests/test_uninitialized_array.cpp.o" "gcc" "CMakeFiles/btree_test.dir/tests/test_uninitialized_array.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_dev_build/_deps/googletest-build/googletest/CMakeFiles/gtest_main.dir/DependInfo.cmake"
+  "/root/repo/_dev_build/_deps/googletest-build/googletest/CMakeFiles/gtest.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
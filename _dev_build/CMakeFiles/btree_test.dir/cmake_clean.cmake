@@ -0,0 +1,34 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/btree_test.dir/tests/test_deque.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_deque.cpp.o.d"
+  "CMakeFiles/btree_test.dir/tests/test_inverted_index.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_inverted_index.cpp.o.d"
+  "CMakeFiles/btree_test.dir/tests/test_iterator_insert_erase.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_iterator_insert_erase.cpp.o.d"
+  "CMakeFiles/btree_test.dir/tests/test_iterators.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_iterators.cpp.o.d"
+  "CMakeFiles/btree_test.dir/tests/test_min.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_min.cpp.o.d"
+  "CMakeFiles/btree_test.dir/tests/test_ordered.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_ordered.cpp.o.d"
+  "CMakeFiles/btree_test.dir/tests/test_random_modifications_indexed.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_random_modifications_indexed.cpp.o.d"
+  "CMakeFiles/btree_test.dir/tests/test_random_modifications_ordered.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_random_modifications_ordered.cpp.o.d"
+  "CMakeFiles/btree_test.dir/tests/test_reference_wrapper.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_reference_wrapper.cpp.o.d"
+  "CMakeFiles/btree_test.dir/tests/test_sum_lower_bound.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_sum_lower_bound.cpp.o.d"
+  "CMakeFiles/btree_test.dir/tests/test_summed_indexed.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_summed_indexed.cpp.o.d"
+  "CMakeFiles/btree_test.dir/tests/test_uninitialized_array.cpp.o"
+  "CMakeFiles/btree_test.dir/tests/test_uninitialized_array.cpp.o.d"
+  "btree_test"
+  "btree_test.pdb"
+  "btree_test[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/btree_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
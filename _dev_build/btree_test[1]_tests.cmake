@@ -0,0 +1,77 @@
+add_test([=[BppTreeTest.TestSignedTransient]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestSignedTransient]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestSignedTransient]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestSignedPersistent]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestSignedPersistent]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestSignedPersistent]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestUnsignedTransient]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestUnsignedTransient]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestUnsignedTransient]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestUnsignedPersistent]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestUnsignedPersistent]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestUnsignedPersistent]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestIterators]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestIterators]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestIterators]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestMinTransient]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestMinTransient]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestMinTransient]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestMinPersistent]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestMinPersistent]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestMinPersistent]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestMaxTransient]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestMaxTransient]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestMaxTransient]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestMaxPersistent]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestMaxPersistent]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestMaxPersistent]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestOrderedTransientLinearSearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestOrderedTransientLinearSearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestOrderedTransientLinearSearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestOrderedTransientBinarySearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestOrderedTransientBinarySearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestOrderedTransientBinarySearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestOrderedTransientBranchlessSearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestOrderedTransientBranchlessSearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestOrderedTransientBranchlessSearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestOrderedTransientInterpolationSearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestOrderedTransientInterpolationSearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestOrderedTransientInterpolationSearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestOrderedPersistentLinearSearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestOrderedPersistentLinearSearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestOrderedPersistentLinearSearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestOrderedPersistentBinarySearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestOrderedPersistentBinarySearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestOrderedPersistentBinarySearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestOrderedPersistentBranchlessSearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestOrderedPersistentBranchlessSearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestOrderedPersistentBranchlessSearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestOrderedPersistentInterpolationSearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestOrderedPersistentInterpolationSearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestOrderedPersistentInterpolationSearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestOrderedTransientSet]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestOrderedTransientSet]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestOrderedTransientSet]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestInterpolationSearchSkewedKeys]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestInterpolationSearchSkewedKeys]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestInterpolationSearchSkewedKeys]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestFindSortedLinearSearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestFindSortedLinearSearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestFindSortedLinearSearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestFindSortedBinarySearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestFindSortedBinarySearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestFindSortedBinarySearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestFindSortedBranchlessSearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestFindSortedBranchlessSearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestFindSortedBranchlessSearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestFindSortedInterpolationSearch]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestFindSortedInterpolationSearch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestFindSortedInterpolationSearch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestUninitializedArray]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestUninitializedArray]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestUninitializedArray]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestReferenceWrapperTransient]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestReferenceWrapperTransient]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestReferenceWrapperTransient]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestReferenceWrapperPersistent]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestReferenceWrapperPersistent]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestReferenceWrapperPersistent]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestRefWrapMin]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestRefWrapMin]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestRefWrapMin]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestIteratorInsertErase]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestIteratorInsertErase]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestIteratorInsertErase]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestIteratorInsertEraseReverse]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestIteratorInsertEraseReverse]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestIteratorInsertEraseReverse]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestDeque]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestDeque]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestDeque]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestPersistentDeque]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestPersistentDeque]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestPersistentDeque]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestPersistentRandomModificationsIndexedIterator]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestPersistentRandomModificationsIndexedIterator]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestPersistentRandomModificationsIndexedIterator]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestPersistentRandomModificationsIndexed]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestPersistentRandomModificationsIndexed]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestPersistentRandomModificationsIndexed]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestSumLowerBound]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestSumLowerBound]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestSumLowerBound]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestInvertedIndex]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestInvertedIndex]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestInvertedIndex]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestPersistentRandomModificationsOrdered]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestPersistentRandomModificationsOrdered]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestPersistentRandomModificationsOrdered]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestPersistentRandomModificationsOrderedIterator]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestPersistentRandomModificationsOrderedIterator]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestPersistentRandomModificationsOrderedIterator]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BppTreeTest.TestTransientRandomModificationsOrdered]=]  /root/repo/_dev_build/btree_test [==[--gtest_filter=BppTreeTest.TestTransientRandomModificationsOrdered]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BppTreeTest.TestTransientRandomModificationsOrdered]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_dev_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  btree_test_TESTS BppTreeTest.TestSignedTransient BppTreeTest.TestSignedPersistent BppTreeTest.TestUnsignedTransient BppTreeTest.TestUnsignedPersistent BppTreeTest.TestIterators BppTreeTest.TestMinTransient BppTreeTest.TestMinPersistent BppTreeTest.TestMaxTransient BppTreeTest.TestMaxPersistent BppTreeTest.TestOrderedTransientLinearSearch BppTreeTest.TestOrderedTransientBinarySearch BppTreeTest.TestOrderedTransientBranchlessSearch BppTreeTest.TestOrderedTransientInterpolationSearch BppTreeTest.TestOrderedPersistentLinearSearch BppTreeTest.TestOrderedPersistentBinarySearch BppTreeTest.TestOrderedPersistentBranchlessSearch BppTreeTest.TestOrderedPersistentInterpolationSearch BppTreeTest.TestOrderedTransientSet BppTreeTest.TestInterpolationSearchSkewedKeys BppTreeTest.TestFindSortedLinearSearch BppTreeTest.TestFindSortedBinarySearch BppTreeTest.TestFindSortedBranchlessSearch BppTreeTest.TestFindSortedInterpolationSearch BppTreeTest.TestUninitializedArray BppTreeTest.TestReferenceWrapperTransient BppTreeTest.TestReferenceWrapperPersistent BppTreeTest.TestRefWrapMin BppTreeTest.TestIteratorInsertErase BppTreeTest.TestIteratorInsertEraseReverse BppTreeTest.TestDeque BppTreeTest.TestPersistentDeque BppTreeTest.TestPersistentRandomModificationsIndexedIterator BppTreeTest.TestPersistentRandomModificationsIndexed BppTreeTest.TestSumLowerBound BppTreeTest.TestInvertedIndex BppTreeTest.TestPersistentRandomModificationsOrdered BppTreeTest.TestPersistentRandomModificationsOrderedIterator BppTreeTest.TestTransientRandomModificationsOrdered)
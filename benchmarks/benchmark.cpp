@@ -32,6 +32,27 @@ inline void random_benchmark(T&& tree, std::string const& message) {
     cout << sum << endl << endl;
 }
 
+template <auto n, typename T>
+inline void snapshot_lookup_benchmark(std::string const& message) {
+    Vector<int32_t> const& rand_ints = RandInts<int32_t, n>::ints;
+    typename T::Transient transient{};
+    for (int i = 0; i < n; i++) {
+        transient.insert_or_assign(rand_ints[i], i);
+    }
+    typename T::Persistent tree = transient.persistent();
+    cout << "Running snapshot lookup benchmark using " << message << " with size " << n << endl;
+    cout << "=============================================================" << endl;
+    int64_t sum = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        sum += tree.at_key(rand_ints[i]);
+    }
+    auto endTime = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = endTime - startTime;
+    cout << elapsed.count() << 's' << endl;
+    cout << sum << endl << endl;
+}
+
 template <typename N, auto n>
 inline void random_benchmarks(std::integral_constant<N, n>) {
     Vector<int32_t> const& rand_ints = RandInts<int32_t, n>::ints;
@@ -39,6 +60,11 @@ inline void random_benchmarks(std::integral_constant<N, n>) {
         random_benchmark<n>(absl::btree_map<int, int>(), "absl::btree_map<int, int>");
         random_benchmark<n>(tlx::btree_map<int, int>(), "tlx::btree_map<int, int>");
         random_benchmark<n>(BppTreeMap<int, int>::Transient(), "BppTreeMap<int, int>::Transient");
+        random_benchmark<n>(BppTreeMap<int, int>::search_mode<SearchMode::binary>::Transient(), "BppTreeMap<int, int>::search_mode<SearchMode::binary>::Transient");
+        random_benchmark<n>(BppTreeMap<int, int>::search_mode<SearchMode::branchless>::Transient(), "BppTreeMap<int, int>::search_mode<SearchMode::branchless>::Transient");
+        random_benchmark<n>(BppTreeMap<int, int>::search_mode<SearchMode::interpolation>::Transient(), "BppTreeMap<int, int>::search_mode<SearchMode::interpolation>::Transient");
+        random_benchmark<n>(BppTreeMap<int, int>::search_mode<SearchMode::binary>::leaf_node_bytes<4096>::Transient(), "BppTreeMap<int, int>::search_mode<SearchMode::binary>::leaf_node_bytes<4096>::Transient");
+        random_benchmark<n>(BppTreeMap<int, int>::search_mode<SearchMode::interpolation>::leaf_node_bytes<4096>::Transient(), "BppTreeMap<int, int>::search_mode<SearchMode::interpolation>::leaf_node_bytes<4096>::Transient");
         random_benchmark<n>(std::map<int, int>(), "std::map<int, int>");
         if constexpr (true) {
             BppTreeMap<int, int>::Transient tree{};
@@ -86,6 +112,8 @@ inline void random_benchmarks(std::integral_constant<N, n>) {
         cout << elapsed.count() << 's' << endl;
         cout << sum << endl << endl;
     }
+    snapshot_lookup_benchmark<n, BppTreeMap<int, int>::search_mode<SearchMode::branchless>>("BppTreeMap<int, int>::search_mode<SearchMode::branchless>::Persistent");
+    snapshot_lookup_benchmark<n, BppTreeMap<int, int>::search_mode<SearchMode::learned>>("BppTreeMap<int, int>::search_mode<SearchMode::learned>::Persistent");
     if constexpr (true) {
         immer::flex_vector<pair<int, int>> vec{};
         cout << "immer::flex_vector<int> : " << n << endl;
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <chrono>
+#include "test_common.hpp"
+
+using namespace std;
+
+// built twice by CMake, once with the default node alignment and once with BPPTREE_NODE_ALIGNMENT=64, so that the
+// output of the two binaries can be compared at each node size
+
+template <auto n, int node_bytes>
+inline void node_size_benchmark() {
+    using TreeType = typename BppTreeMap<int, int>::leaf_node_bytes<node_bytes>::template internal_node_bytes<node_bytes>;
+    Vector<int32_t> const& rand_ints = RandInts<int32_t, n>::ints;
+    cout << "Running node alignment benchmark with " << node_bytes << " byte nodes, node alignment "
+         << bpptree::detail::node_alignment << " and size " << n << endl;
+    cout << "=============================================================" << endl;
+    typename TreeType::Transient tree{};
+    auto startTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        tree.insert_or_assign(rand_ints[i], i);
+    }
+    auto endTime = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = endTime - startTime;
+    cout << "insert: " << elapsed.count() << 's' << endl;
+
+    int64_t sum = 0;
+    startTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        sum += tree.at_key(rand_ints[i]);
+    }
+    endTime = std::chrono::steady_clock::now();
+    elapsed = endTime - startTime;
+    cout << "lookup: " << elapsed.count() << 's' << endl;
+    cout << sum << endl << endl;
+}
+
+template <typename N, auto n>
+inline void node_size_benchmarks(std::integral_constant<N, n>) {
+    for (int j = 0; j < 3; ++j) {
+        node_size_benchmark<n, 256>();
+        node_size_benchmark<n, 512>();
+        node_size_benchmark<n, 1024>();
+        node_size_benchmark<n, 2048>();
+        node_size_benchmark<n, 4096>();
+    }
+}
+
+int main() {
+    auto sizes = std::make_tuple(
+            integral_constant<bpptree::detail::ssize, 1 << 23>(),
+            integral_constant<bpptree::detail::ssize, 1 << 19>(),
+            integral_constant<bpptree::detail::ssize, 1 << 15>());
+    apply([](auto... n){ (node_size_benchmarks(n), ...); }, sizes);
+}
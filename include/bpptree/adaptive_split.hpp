@@ -0,0 +1,142 @@
+//
+// B++ Tree: A B+ Tree library written in C++
+// Copyright (C) 2023 Jeff Plaisance
+//
+// This software is distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://boost.org/LICENSE_1_0.txt
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "bpptree/detail/helpers.hpp"
+
+namespace bpptree {
+namespace detail {
+
+/**
+ * AdaptiveSplit mixin chooses where to split each full node based on where the recent inserts into that node were.
+ * By default nodes are split in the middle, except for appends to the end of the tree, which leave the left node
+ * full. Ascending or descending runs of inserts anywhere else, such as descending timestamps inserted at the front
+ * of the tree or sequential keys inserted into the middle of it, leave half full nodes behind. With this mixin each
+ * node remembers the position of its last insert, and once two inserts in a row continue a run the node is split
+ * next to the new value instead of in the middle, so the nodes a run leaves behind are nearly full.
+ * Random inserts almost never form runs, so they are split in the middle as before.
+ * @tparam Value the value type of the B++ tree
+ */
+template <typename Value>
+struct AdaptiveSplit {
+    // position of the last insert into a node and the length of the run of inserts leading up to it. a positive
+    // length counts inserts each one position after the previous one, a negative length counts inserts at the same
+    // position as the previous one, which is where values smaller than the previous one are inserted.
+    struct SplitRun {
+        static constexpr int32_t none = std::numeric_limits<int32_t>::min() / 2;
+
+        static constexpr int32_t min_run = 2;
+
+        int32_t last = none;
+        int32_t length = 0;
+
+        [[nodiscard]] SplitRun next(IndexType index) const {
+            auto i = static_cast<int32_t>(index);
+            if (i == last + 1) {
+                return {i, std::min(std::max(length, 0) + 1, min_run)};
+            }
+            if (i == last) {
+                return {i, std::max(std::min(length, 0) - 1, -min_run)};
+            }
+            return {i, 0};
+        }
+
+        // the run as seen from the right node of a split, where positions are shifted down by split_point
+        [[nodiscard]] SplitRun shift(IndexType split_point) const {
+            return {static_cast<int32_t>(last - split_point), length};
+        }
+
+        [[nodiscard]] IndexType direction() const {
+            return length >= min_run ? 1 : length <= -min_run ? -1 : 0;
+        }
+    };
+
+    static constexpr size_t sizeof_hint() {
+        return 0;
+    }
+
+    template <typename Parent>
+    struct LeafNode : public Parent {
+        using NodeType = typename Parent::NodeType;
+
+        SplitRun split_run{};
+
+        void on_insert2(NodeType const& source, IndexType index) {
+            split_run = source.split_run.next(index);
+            Parent::on_insert2(source, index);
+        }
+
+        IndexType split_point2(NodeType& left, NodeType& right, IndexType index, bool right_most) const {
+            SplitRun run = split_run.next(index);
+            IndexType split_point = Parent::split_point(index, right_most, run.direction());
+            left.split_run = run;
+            right.split_run = run.shift(split_point);
+            return split_point;
+        }
+    };
+
+    template <typename Parent, auto internal_size>
+    struct InternalNode : public Parent {
+        using NodeType = typename Parent::NodeType;
+
+        SplitRun split_run{};
+
+        void on_split_child2(NodeType const& source, IndexType index) {
+            split_run = source.split_run.next(index);
+            Parent::on_split_child2(source, index);
+        }
+
+        IndexType split_point2(NodeType& left, NodeType& right, IndexType index, bool right_most) const {
+            SplitRun run = split_run.next(index);
+            IndexType split_point = Parent::split_point(index, right_most, run.direction());
+            left.split_run = run;
+            right.split_run = run.shift(split_point);
+            return split_point;
+        }
+    };
+
+    template <typename Parent>
+    struct NodeInfo : public Parent {
+        NodeInfo() = default;
+
+        template <typename P>
+        NodeInfo(P const& p, const bool changed) : Parent(p, changed) {}
+    };
+
+    template <typename Parent>
+    struct Shared : public Parent {
+        template <typename... Us>
+        explicit Shared(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+    };
+
+    template <typename Parent>
+    struct Transient : public Parent {
+        template <typename... Us>
+        explicit Transient(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+    };
+
+    template <typename Parent>
+    struct Persistent : public Parent {
+        template <typename... Us>
+        explicit Persistent(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+    };
+};
+
+struct AdaptiveSplitBuilder {
+    template <typename Value>
+    using build = AdaptiveSplit<Value>;
+};
+} //end namespace detail
+using detail::AdaptiveSplit;
+using detail::AdaptiveSplitBuilder;
+} //end namespace bpptree
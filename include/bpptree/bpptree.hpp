@@ -12,6 +12,9 @@
 #include <cstdint>
 #include <variant>
 #include <algorithm>
+#include <iterator>
+#include <vector>
+#include <optional>
 
 #include "bpptree/detail/operations.hpp"
 #include "bpptree/detail/sandwich.hpp"
@@ -20,6 +23,8 @@
 #include "bpptree/detail/leafnodebase.hpp"
 #include "bpptree/detail/internalnodebase.hpp"
 #include "bpptree/detail/iterator.hpp"
+#include "bpptree/detail/span.hpp"
+#include "bpptree/detail/splittable_range.hpp"
 #include "bpptree/detail/nodetypes.hpp"
 #include "bpptree/detail/modify.hpp"
 
@@ -92,7 +97,7 @@ public:
         }
 
         template <bool is_const, bool reverse>
-        using IteratorType = IteratorDetail<Value, typename Parent::SelfType, LeafNode, is_const, reverse>;
+        using IteratorType = IteratorDetail<Value, typename Parent::SelfType, LeafNode, InternalNode<2>, is_const, reverse>;
 
     public:
         [[nodiscard]] size_t size() const {
@@ -203,6 +208,132 @@ public:
         [[nodiscard]] bool empty() const {
             return tree_size == 0;
         }
+
+        /**
+         * Calls f with a Span<Value const> over each run of values in [first, last) that is stored contiguously in one
+         * leaf, in order. This lets scans run tight loops over the values of each leaf instead of paying for an
+         * iterator increment and dereference per value. The spans must not be used after the tree is modified.
+         */
+        template <typename It, typename F>
+        void for_each_chunk(It first, It const& last, F&& f) const {
+            static_assert(!It::is_reversed, "for_each_chunk requires forward iterators");
+            first.fix_leaf();
+            last.fix_leaf();
+            while (true) {
+                IndexType begin = LeafNode::get_index(first.iter);
+                IndexType end = first.leaf == last.leaf ? LeafNode::get_index(last.iter) : first.leaf->length;
+                if (end > begin) {
+                    f(Span<Value const>(&first.leaf->values[begin], static_cast<size_t>(end - begin)));
+                }
+                if (first.leaf == last.leaf) {
+                    return;
+                }
+                first.advance(end - begin);
+            }
+        }
+
+        /**
+         * Calls f with a Span<Value const> over the values of each leaf of the tree, in order.
+         */
+        template <typename F>
+        void for_each_chunk(F&& f) const {
+            for_each_chunk(cbegin(), cend(), std::forward<F>(f));
+        }
+
+        /**
+         * Calls f with each value in [first, last), in order. This recurses directly over the nodes of the tree, so
+         * it is faster than iterating from first to last, but f must not modify the tree.
+         */
+        template <typename It, typename F>
+        void for_each(It const& first, It const& last, F&& f) const {
+            static_assert(!It::is_reversed, "for_each requires forward iterators");
+            if (first == last) {
+                return;
+            }
+            this->self().dispatch([&first, &last, &f](auto const& root) {
+                root->for_each(first.iter, last.iter, true, true, f);
+            });
+        }
+
+        /**
+         * Calls f with each value of the tree, in order. f must not modify the tree.
+         */
+        template <typename F>
+        void for_each(F&& f) const {
+            for_each(cbegin(), cend(), std::forward<F>(f));
+        }
+
+        /**
+         * Folds the values in [first, last) into init from left to right with op, which is called as
+         * op(accumulator, value) and must return the new accumulator. Like for_each this does not use iterators.
+         */
+        template <typename It, typename T, typename Op>
+        [[nodiscard]] T reduce(It const& first, It const& last, T init, Op&& op) const {
+            for_each(first, last, [&init, &op](Value const& value) { init = op(std::move(init), value); });
+            return init;
+        }
+
+        /**
+         * Folds all values of the tree into init from left to right with op.
+         */
+        template <typename T, typename Op>
+        [[nodiscard]] T reduce(T init, Op&& op) const {
+            return reduce(cbegin(), cend(), std::move(init), std::forward<Op>(op));
+        }
+
+        /**
+         * Cuts [first, last) into k consecutive subranges of about the same size, in O(k log N). With the Indexed
+         * mixin the subranges differ in size by at most one value. Without it the cuts are placed by assuming that
+         * all nodes on the same level hold the same number of values. Nodes are not kept at a minimum fill, since
+         * erase never merges or rebalances them, so after many erases the subranges can differ in size by much more
+         * than a factor of two. Use the Indexed mixin where even subranges matter.
+         * Subranges may be empty if [first, last) holds fewer than k values. Each subrange can be split further.
+         */
+        template <typename It>
+        [[nodiscard]] std::vector<SplittableRange<It>> split_range(It const& first, It const& last, size_t k) const {
+            static_assert(!It::is_reversed, "split_range requires forward iterators");
+            std::vector<SplittableRange<It>> ret{};
+            ret.reserve(k);
+            It begin = first;
+            if (first != last) {
+                if constexpr (IsIndexedTree<typename Parent::SelfType, It const&>::value) {
+                    auto total = static_cast<ssize>(this->self().order(last) - this->self().order(first));
+                    ssize position = 0;
+                    for (size_t i = 1; i < k; ++i) {
+                        auto next = static_cast<ssize>(static_cast<size_t>(total) * i / k);
+                        It end = begin;
+                        end += next - position;
+                        position = next;
+                        ret.emplace_back(begin, end);
+                        begin = end;
+                    }
+                } else {
+                    auto [from, to] = this->self().dispatch([&first, &last](auto const& root) {
+                        return std::make_pair(root->fraction(first.iter), root->fraction(last.iter));
+                    });
+                    for (size_t i = 1; i < k; ++i) {
+                        It end = first;
+                        end.parent = nullptr;
+                        double fraction = from + (to - from) * static_cast<double>(i) / static_cast<double>(k);
+                        this->self().dispatch([&end, fraction](auto const& root) { root->seek_fraction(end, fraction); });
+                        if (end < begin) {
+                            end = begin;
+                        } else if (last < end) {
+                            end = last;
+                        }
+                        ret.emplace_back(begin, end);
+                        begin = end;
+                    }
+                }
+            }
+            while (ret.size() + 1 < k) {
+                ret.emplace_back(begin, begin);
+            }
+            if (k > 0) {
+                ret.emplace_back(begin, last);
+            }
+            return ret;
+        }
     };
 private:
 
@@ -239,18 +370,33 @@ public:
 
         uint64_t mod_count = 0;
 
+        // changes whenever a leaf that only this tree could see may have been removed from it and freed, or shared
+        // with a snapshot so that a later modification may replace it with a copy
+        mutable uint64_t epoch = 0;
+
     public:
         template <typename... Us>
         explicit Transient(Us&&... us) : Parent(std::forward<Us>(us)...) {}
 
         [[nodiscard]] Persistent persistent() const& {
+            ++epoch;
             return Persistent(this->root_variant, this->tree_size);
         }
 
         [[nodiscard]] Persistent persistent() && {
+            ++epoch;
             return Persistent(std::move(this->root_variant), this->tree_size);
         }
 
+        /**
+         * @return a count that changes whenever a leaf of this tree that was not shared with a snapshot may have been
+         * removed from it, or is shared with a snapshot from then on. A pointer to such a leaf found while the count
+         * is unchanged still points to a leaf of this tree, though values may have moved within it or out of it.
+         */
+        [[nodiscard]] uint64_t leaf_epoch() const {
+            return epoch;
+        }
+
     private:
         friend Persistent;
 
@@ -294,6 +440,33 @@ public:
             this->self().dispatch(Modify<Update>(), find_iterator, it.iter, updater);
         }
 
+        /**
+         * Calls f with a mutable Span<Value> over each run of values in [first, last) that is stored contiguously in
+         * one leaf, in order, so that a range of values can be updated in place without a descent from the root per
+         * value. Nodes shared with persistent trees are copied before f sees them. After f returns for a leaf, the
+         * state mixins keep for its values, such as sums, mins, maxes, and last keys, is recomputed once for each node
+         * on the path to the root. f may change values but must not change the keys of Ordered trees in a way that
+         * breaks their order, and the spans must not be used after f returns. Like assign, this does not invalidate
+         * iterators.
+         */
+        template <typename It, typename F>
+        void update_chunks(It const& first, It const& last, F&& f) {
+            static_assert(!std::decay_t<It>::is_reversed, "update_chunks requires forward iterators");
+            if (first == last) {
+                return;
+            }
+            bool copied = std::visit([&first, &last, &f](auto& root) {
+                bool root_copied = root->persistent;
+                if (root_copied) {
+                    root = make_ptr<std::remove_reference_t<decltype(*root)>>(*root);
+                }
+                return root->update_chunks(first.iter, last.iter, true, true, f) || root_copied;
+            }, this->root_variant);
+            if (copied) {
+                ++mod_count;
+            }
+        }
+
         template <typename... Args>
         void emplace_front(Args&&... args) {
             this->self().dispatch(Modify<Insert>(), find_first, Empty::empty, std::forward<Args>(args)...);
@@ -330,12 +503,314 @@ public:
             this->self().root_variant = make_ptr<LeafNode>();
             this->tree_size = 0;
             this->mod_count++;
+            ++epoch;
+        }
+
+    private:
+        // the range of the count items that goes to the index'th of nodes nodes when the items are spread evenly
+        [[nodiscard]] static std::pair<size_t, size_t> packed_range(size_t count, size_t nodes, size_t index) {
+            size_t per_node = count / nodes;
+            size_t extra = count % nodes;
+            size_t begin = index * per_node + std::min(index, extra);
+            return {begin, begin + per_node + (index < extra ? 1 : 0)};
+        }
+
+        // packs children into as few parents as possible and repeats with the parents until one node is left, which
+        // becomes the root. depth is the depth of the parents.
+        template <int depth, typename ChildType, typename Run>
+        void build_levels(std::vector<NodePtr<ChildType>>& children, Run& run) {
+            if (children.size() == 1) {
+                this->root_variant = std::move(children[0]);
+                return;
+            }
+            if constexpr (depth <= max_depth_v) {
+                using NodeType = InternalNode<depth>;
+                using InfoType = typename NodeType::template InfoType<ChildType>;
+                size_t count = (children.size() + internal_node_size - 1) / internal_node_size;
+                std::vector<NodePtr<NodeType>> nodes(count);
+                run(count, [&children, &nodes, count](size_t first, size_t last) {
+                    for (size_t i = first; i < last; ++i) {
+                        auto [begin, end] = packed_range(children.size(), count, i);
+                        auto node = make_ptr<NodeType>();
+                        for (size_t j = begin; j < end; ++j) {
+                            InfoType info(std::move(children[j]), true);
+                            node->set_element(static_cast<IndexType>(j - begin), info);
+                        }
+                        node->length = static_cast<uint16_t>(end - begin);
+                        nodes[i] = std::move(node);
+                    }
+                });
+                build_levels<depth + 1>(nodes, run);
+            } else {
+                // unreachable for at most max_size_v values, since every level is packed
+#ifdef BPPTREE_SAFETY_CHECKS
+                throw std::logic_error("maximum depth exceeded");
+#endif
+            }
+        }
+
+        // returns a copy of node with subtree added on its own level, as the last node of that level below node if
+        // at_end and as the first otherwise. only the nodes on the path down to that level are copied. when a node on
+        // the path is full, the added node goes into a new sibling instead, which is returned in overflow for the
+        // level above to add.
+        template <bool at_end, typename NodeType, typename SubtreeType>
+        static NodePtr<NodeType> join_subtree(
+                NodeType const& node,
+                NodePtr<SubtreeType> const& subtree,
+                std::optional<NodePtr<NodeType>>& overflow
+        ) {
+            using ChildType = typename NodeType::ChildType;
+            using InfoType = typename NodeType::template InfoType<ChildType>;
+            IndexType edge = at_end ? node.length - 1 : 0;
+            std::optional<NodePtr<ChildType>> edge_child{};
+            std::optional<NodePtr<ChildType>> added{};
+            if constexpr (std::is_same_v<ChildType, SubtreeType>) {
+                added = subtree;
+            } else {
+                edge_child = join_subtree<at_end>(*node.pointers[edge], subtree, added);
+            }
+            bool fits = added.has_value() && node.length < internal_node_size;
+            IndexType offset = fits && !at_end ? 1 : 0;
+            auto ret = make_ptr<NodeType>();
+            for (IndexType i = 0; i < node.length; ++i) {
+                if (edge_child && i == edge) {
+                    InfoType info(std::move(*edge_child), true);
+                    ret->set_element(i + offset, info);
+                } else {
+                    ret->copy_element(i + offset, node, i);
+                }
+            }
+            if (added) {
+                InfoType info(std::move(*added), true);
+                if (fits) {
+                    ret->set_element(at_end ? node.length : 0, info);
+                } else {
+                    auto sibling = make_ptr<NodeType>();
+                    sibling->set_element(0, info);
+                    sibling->length = 1;
+                    overflow = std::move(sibling);
+                }
+            }
+            ret->length = static_cast<uint16_t>(node.length + (fits ? 1 : 0));
+            return ret;
+        }
+
+        // a new root of depth depth over left and right, or nothing if that is deeper than max_depth_v
+        template <int depth, typename ChildType>
+        static std::optional<RootType> join_root(NodePtr<ChildType>&& left, NodePtr<ChildType>&& right) {
+            if constexpr (depth <= max_depth_v) {
+                using NodeType = InternalNode<depth>;
+                using InfoType = typename NodeType::template InfoType<ChildType>;
+                auto root = make_ptr<NodeType>();
+                InfoType left_info(std::move(left), true);
+                root->set_element(0, left_info);
+                InfoType right_info(std::move(right), true);
+                root->set_element(1, right_info);
+                root->length = 2;
+                return RootType(std::move(root));
+            } else {
+                return std::nullopt;
+            }
+        }
+
+        // the root of the tree holding the values of left followed by the values of right. the shorter tree is added
+        // as a whole on its own level along the facing edge of the taller one, so this copies at most the nodes on
+        // that edge plus one new root. returns nothing if the result would be deeper than max_depth_v.
+        template <typename LeftType, typename RightType>
+        static std::optional<RootType> join_trees(NodePtr<LeftType> const& left, NodePtr<RightType> const& right) {
+            if constexpr (LeftType::depth > RightType::depth) {
+                std::optional<NodePtr<LeftType>> overflow{};
+                auto root = join_subtree<true>(*left, right, overflow);
+                if (!overflow) {
+                    return RootType(std::move(root));
+                }
+                return join_root<LeftType::depth + 1>(std::move(root), std::move(*overflow));
+            } else if constexpr (LeftType::depth < RightType::depth) {
+                std::optional<NodePtr<RightType>> overflow{};
+                auto root = join_subtree<false>(*right, left, overflow);
+                if (!overflow) {
+                    return RootType(std::move(root));
+                }
+                return join_root<RightType::depth + 1>(std::move(*overflow), std::move(root));
+            } else {
+                return join_root<LeftType::depth + 1>(NodePtr<LeftType>(left), NodePtr<RightType>(right));
+            }
+        }
+
+    public:
+        /**
+         * Replaces the contents of this tree with the values in [first, last), which must already be in the order
+         * the tree keeps them in, such as sorted by key for Ordered trees. Instead of inserting the values one at a
+         * time, this fills nearly full leaves and builds each level of internal nodes from the level below in O(N).
+         * run(count, body) must call body(begin, end) for disjoint ranges that cover [0, count). It may do so from
+         * several threads at once to build the nodes of each level in parallel.
+         */
+        template <typename It, typename Run>
+        void assign_sorted(It first, It last, Run&& run) {
+            auto size = static_cast<size_t>(last - first);
+#ifdef BPPTREE_SAFETY_CHECKS
+            if (size > max_size_v) {
+                throw std::logic_error("maximum depth exceeded");
+            }
+#endif
+            if (size == 0) {
+                clear();
+                return;
+            }
+            size_t count = (size + leaf_node_size - 1) / leaf_node_size;
+            std::vector<NodePtr<LeafNode>> leaves(count);
+            run(count, [&first, &leaves, size, count](size_t begin_leaf, size_t end_leaf) {
+                for (size_t i = begin_leaf; i < end_leaf; ++i) {
+                    auto [begin, end] = packed_range(size, count, i);
+                    auto leaf = make_ptr<LeafNode>();
+                    It it = first + static_cast<ssize>(begin);
+                    for (size_t j = begin; j < end; ++j, ++it) {
+                        leaf->values.emplace(j - begin, leaf->length, *it);
+                    }
+                    leaf->length = static_cast<uint16_t>(end - begin);
+                    leaf->on_split2();
+                    leaves[i] = std::move(leaf);
+                }
+            });
+            build_levels<2>(leaves, run);
+            this->tree_size = size;
+            ++mod_count;
+            ++epoch;
+        }
+
+        /**
+         * Replaces the contents of this tree with the values in [first, last), which must already be in the order
+         * the tree keeps them in, in O(N)
+         */
+        template <typename It>
+        void assign_sorted(It first, It last) {
+            assign_sorted(first, last, [](size_t count, auto const& body) { body(0, count); });
+        }
+
+        /**
+         * Replaces the contents of this tree with values produced in parts, one part after the other. fill(part, emit)
+         * must call emit(value) for each value of the part, in the order the tree keeps them in. The values of each
+         * part go straight into full leaves of their own, except for its last leaf, and the leaves of all parts are
+         * then linked like in assign_sorted. run(count, body) is used as in assign_sorted, so parts may be filled in
+         * parallel.
+         */
+        template <typename Fill, typename Run>
+        void assign_parts(size_t parts, Fill const& fill, Run&& run) {
+            std::vector<std::vector<NodePtr<LeafNode>>> part_leaves(parts);
+            std::vector<size_t> part_sizes(parts);
+            run(parts, [&fill, &part_leaves, &part_sizes](size_t first, size_t last) {
+                for (size_t part = first; part < last; ++part) {
+                    auto& leaves = part_leaves[part];
+                    size_t size = 0;
+                    // the last leaf is kept in leaves while it is filled
+                    fill(part, [&leaves, &size](auto&& value) {
+                        if (leaves.empty() || leaves.back()->length == leaf_node_size) {
+                            if (!leaves.empty()) {
+                                leaves.back()->on_split2();
+                            }
+                            leaves.push_back(make_ptr<LeafNode>());
+                        }
+                        LeafNode& leaf = *leaves.back();
+                        leaf.values.emplace(leaf.length, leaf.length, std::forward<decltype(value)>(value));
+                        ++leaf.length;
+                        ++size;
+                    });
+                    if (!leaves.empty()) {
+                        leaves.back()->on_split2();
+                    }
+                    part_sizes[part] = size;
+                }
+            });
+            std::vector<NodePtr<LeafNode>> leaves{};
+            size_t size = 0;
+            for (size_t part = 0; part < parts; ++part) {
+                std::move(part_leaves[part].begin(), part_leaves[part].end(), std::back_inserter(leaves));
+                size += part_sizes[part];
+            }
+#ifdef BPPTREE_SAFETY_CHECKS
+            if (size > max_size_v) {
+                throw std::logic_error("maximum depth exceeded");
+            }
+#endif
+            if (leaves.empty()) {
+                clear();
+                return;
+            }
+            build_levels<2>(leaves, run);
+            this->tree_size = size;
+            ++mod_count;
+            ++epoch;
+        }
+
+        /**
+         * Replaces the contents of this tree with the values of trees, which must be Persistent trees of this type,
+         * one after the other. Their values must already be in the order this tree keeps them in. Instead of copying
+         * values, each tree is joined in whole at the level of its root, copying only the nodes along the edge it is
+         * joined to, so this is O(number of trees * depth) and shares all other nodes with trees. Joining many sparse
+         * trees can overrun max_depth() even when the values would fit, in which case the leaves of trees are
+         * repacked under new internal nodes instead, which is O(N / leaf size).
+         */
+        template <typename Trees>
+        void assign_concatenated(Trees const& trees) {
+            size_t size = 0;
+            for (auto const& tree : trees) {
+                size += tree.size();
+            }
+#ifdef BPPTREE_SAFETY_CHECKS
+            if (size > max_size_v) {
+                throw std::logic_error("maximum depth exceeded");
+            }
+#endif
+            std::optional<RootType> root{};
+            for (auto const& tree : trees) {
+                if (tree.empty()) {
+                    continue;
+                }
+                if (!root) {
+                    root = tree.root_variant;
+                    continue;
+                }
+                root = std::visit([](auto const& left, auto const& right) {
+                    return join_trees(left, right);
+                }, *root, tree.root_variant);
+                if (!root) {
+                    break;
+                }
+            }
+            if (size == 0) {
+                clear();
+                return;
+            }
+            if (root) {
+                this->root_variant = std::move(*root);
+            } else {
+                std::vector<NodePtr<LeafNode>> leaves{};
+                for (auto const& tree : trees) {
+                    std::visit([&leaves](auto const& tree_root) {
+                        using NodeType = std::remove_cv_t<std::remove_reference_t<decltype(*tree_root)>>;
+                        if constexpr (std::is_same_v<NodeType, LeafNode>) {
+                            if (tree_root->length > 0) {
+                                leaves.push_back(tree_root);
+                            }
+                        } else {
+                            tree_root->collect_subtrees(leaves);
+                        }
+                    }, tree.root_variant);
+                }
+                auto run = [](size_t count, auto const& body) { body(0, count); };
+                build_levels<2>(leaves, run);
+            }
+            this->tree_size = size;
+            ++mod_count;
+            ++epoch;
         }
     };
 
     struct Persistent : public PersistentMixin<Persistent> {
     private:
         using Parent = PersistentMixin<Persistent>;
+
+        friend Transient;
     public:
         template <typename... Us>
         explicit Persistent(Us&&... us) : Parent(std::forward<Us>(us)...) {
@@ -348,6 +823,46 @@ public:
             return Transient(this->root_variant, this->tree_size);
         }
 
+    private:
+        template <typename F>
+        [[nodiscard]] Persistent copy_nodes(F const& copy) const {
+            RootType root = std::visit([&copy](auto const& root) -> RootType {
+                auto ret = copy(*root);
+                for (int distance = 0; distance < ret->depth - 1; ++distance) {
+                    if constexpr (std::decay_t<decltype(*root)>::depth > 1) {
+                        ret->copy_level(copy, distance);
+                    }
+                }
+                return ret;
+            }, this->root_variant);
+            return Persistent(std::move(root), this->tree_size);
+        }
+
+    public:
+        /**
+         * Copies every node of this tree into contiguous memory in level order (the root first, then all of its
+         * children, and so on) so that lookups and scans of a long lived read mostly snapshot touch fewer pages.
+         * The returned tree supports every operation a normal Persistent tree does. Modifying it copies the modified
+         * nodes out of the frozen memory, which is released once every frozen node is no longer referenced.
+         * @return a frozen copy of this tree
+         */
+        [[nodiscard]] Persistent freeze() const {
+            Arena arena{};
+            return copy_nodes([&arena](auto const& node) {
+                return make_arena_ptr<std::decay_t<decltype(node)>>(arena, node);
+            });
+        }
+
+        /**
+         * @return a copy of this tree where every node is individually heap allocated, releasing the frozen memory
+         * once nothing else references it
+         */
+        [[nodiscard]] Persistent thaw() const {
+            return copy_nodes([](auto const& node) {
+                return make_ptr<std::decay_t<decltype(node)>>(node);
+            });
+        }
+
         [[nodiscard]] Transient transient() && {
             return Transient(std::move(this->root_variant), this->tree_size);
         }
@@ -429,4 +944,6 @@ struct BppTree {
 };
 } //end namespace detail
 using detail::BppTree;
+using detail::Span;
+using detail::SplittableRange;
 } //end namespace bpptree
@@ -0,0 +1,101 @@
+//
+// B++ Tree: A B+ Tree library written in C++
+// Copyright (C) 2023 Jeff Plaisance
+//
+// This software is distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://boost.org/LICENSE_1_0.txt
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+namespace bpptree::detail {
+
+/**
+ * Header at the start of every arena chunk. Chunks are aligned to their size so the chunk that owns a node can be found
+ * by masking the node's address, which means nodes do not need to store a pointer to their arena.
+ * live counts the nodes in the chunk that have not been released yet plus one for the Arena that is still filling it.
+ * The chunk is freed when live reaches 0.
+ */
+struct ArenaChunk {
+    static constexpr size_t chunk_bytes = 2 * 1024 * 1024;
+
+    std::atomic<size_t> live = 1;
+    size_t used = sizeof(ArenaChunk);
+
+    static ArenaChunk* allocate() {
+        // the aligned operator new reports failure the same way node allocations do, which also works when
+        // exceptions are disabled
+        void* p = ::operator new(chunk_bytes, std::align_val_t(chunk_bytes));
+        return new (p) ArenaChunk();
+    }
+
+    static ArenaChunk* owner(void const* p) {
+        return reinterpret_cast<ArenaChunk*>(reinterpret_cast<uintptr_t>(p) & ~(uintptr_t{chunk_bytes} - 1));
+    }
+
+    void release() {
+        if (live.fetch_sub(1, std::memory_order_release) == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            this->~ArenaChunk();
+            ::operator delete(static_cast<void*>(this), std::align_val_t(chunk_bytes));
+        }
+    }
+};
+
+/**
+ * Releases the memory of a node that was allocated by an Arena. The node must already have been destroyed.
+ */
+inline void arena_release(void const* p) {
+    ArenaChunk::owner(p)->release();
+}
+
+/**
+ * Bump allocator that places nodes contiguously, in the order they are allocated, in 2MB chunks.
+ * Nodes allocated by an arena (see make_arena_ptr) are marked with in_arena so that NodePtr returns them with
+ * arena_release instead of delete. Chunks are reference counted by their nodes, so the Arena itself can be destroyed
+ * as soon as allocation is finished and memory is returned once every node in a chunk has been released.
+ */
+class Arena {
+    ArenaChunk* current = nullptr;
+
+public:
+    Arena() = default;
+
+    Arena(Arena const&) = delete;
+
+    Arena& operator=(Arena const&) = delete;
+
+    ~Arena() {
+        if (current != nullptr) {
+            current->release();
+        }
+    }
+
+    /**
+     * @return uninitialized memory for an object of the given size and alignment. commit must be called once an
+     * object has been constructed in it.
+     */
+    void* allocate(size_t bytes, size_t alignment) {
+        if (current != nullptr) {
+            size_t offset = (current->used + alignment - 1) & ~(alignment - 1);
+            if (offset + bytes <= ArenaChunk::chunk_bytes) {
+                current->used = offset + bytes;
+                return reinterpret_cast<char*>(current) + offset;
+            }
+            current->release();
+        }
+        current = ArenaChunk::allocate();
+        size_t offset = (current->used + alignment - 1) & ~(alignment - 1);
+        current->used = offset + bytes;
+        return reinterpret_cast<char*>(current) + offset;
+    }
+
+    static void commit(void const* p) {
+        ArenaChunk::owner(p)->live.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+} //end namespace bpptree::detail
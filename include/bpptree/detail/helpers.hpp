@@ -31,6 +31,18 @@ static constexpr bool default_disable_exceptions =
     BPPTREE_DISABLE_EXCEPTIONS;
 #endif
 
+// Alignment of every node in bytes, or 0 for the default alignment of the node type. Defining BPPTREE_NODE_ALIGNMENT
+// to the cache line size, typically 64, allocates nodes on cache line boundaries and rounds node sizes up to a whole
+// number of cache lines. The node header and the start of the node's values then share the first line of the node and
+// a node of n cache lines never spans n + 1 lines. Node sizes are chosen so that padded nodes still fit in the
+// configured number of bytes.
+static constexpr size_t node_alignment =
+#ifndef BPPTREE_NODE_ALIGNMENT
+    0;
+#else
+    BPPTREE_NODE_ALIGNMENT;
+#endif
+
 template <size_t index = 0>
 struct TupleExtractor {
     template <typename... Ts>
@@ -199,6 +211,9 @@ struct Replace {
     // if carry is true, the last element in the child was erased and the iterator should point at the first element of
     // the next child
     bool carry = false;
+    // true if a node below the one receiving this was copied, such as a leaf shared with a persistent tree, or an
+    // emptied child was removed, so that leaves may have moved or been freed even though delta.ptr did not change
+    bool copied = false;
 };
 
 template <typename NodeInfoType>
@@ -248,14 +263,62 @@ struct IsTransientTree : std::true_type {};
 template<typename T>
 struct IsTransientTree<T, std::void_t<decltype(std::declval<T>().transient())>> : std::false_type {};
 
+template<typename T, typename = void>
+struct HasOffsetLeaves : std::false_type {};
+
+template<typename T>
+struct HasOffsetLeaves<T, std::void_t<decltype(T::offset_leaves)>> : std::bool_constant<T::offset_leaves> {};
+
 enum struct DuplicatePolicy {
     replace,
     ignore,
     insert
 };
 
+/**
+ * How Ordered searches for a key within a node.
+ * linear scans from the front and stops at the first key that is not less than the search key.
+ * binary uses std::lower_bound.
+ * branchless is a binary search that selects the next half with a conditional move instead of a branch, so random
+ * keys do not cause branch mispredictions.
+ * interpolation estimates the position of the key from the first and last keys in the node and then scans locally
+ * from the estimate. it is only used for arithmetic keys, other key types fall back to branchless.
+ * learned fits a linear model of key to position in each node when the node becomes persistent and searches only the
+ * window around the predicted position that is guaranteed by the model's maximum error. nodes that are not persistent
+ * yet and non-arithmetic keys use branchless.
+ */
+enum struct SearchMode {
+    linear,
+    binary,
+    branchless,
+    interpolation,
+    learned
+};
+
+template <SearchMode mode>
+using SearchPolicy = std::integral_constant<SearchMode, mode>;
+
+/**
+ * Converts the BinarySearch policy of Ordered into a SearchMode. std::false_type and std::true_type select linear and
+ * binary search for backwards compatibility, SearchPolicy<mode> selects mode.
+ */
+template <typename T>
+struct ToSearchMode {
+    static constexpr SearchMode value = T::value ? SearchMode::binary : SearchMode::linear;
+};
+
+template <SearchMode mode>
+struct ToSearchMode<SearchPolicy<mode>> {
+    static constexpr SearchMode value = mode;
+};
+
+template <typename T>
+inline constexpr SearchMode search_mode_v = ToSearchMode<T>::value;
+
 } //end namespace detail
 using detail::TupleExtractor;
 using detail::PairExtractor;
 using detail::ValueExtractor;
+using detail::SearchMode;
+using detail::SearchPolicy;
 } //end namespace bpptree
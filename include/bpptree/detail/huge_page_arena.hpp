@@ -0,0 +1,329 @@
+//
+// B++ Tree: A B+ Tree library written in C++
+// Copyright (C) 2023 Jeff Plaisance
+//
+// This software is distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://boost.org/LICENSE_1_0.txt
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace bpptree::detail {
+
+struct HugePageSizeClass;
+
+/**
+ * Header at the start of every huge page chunk. A chunk holds nodes of a single size, so nodes that are released can
+ * be reused by the next allocation of the same size. Chunks are aligned to their size so the chunk that owns a node
+ * can be found by masking the node's address.
+ * Released slots are pushed onto released without a lock, and are moved to free in a batch by the next allocation
+ * that finds free empty. Everything else belongs to the mutex of the size class.
+ */
+struct HugePageChunk {
+    static constexpr size_t chunk_bytes = 2 * 1024 * 1024;
+
+    HugePageSizeClass* size_class;
+    size_t slot_bytes;
+    // offset of the first slot that has never been handed out
+    size_t used;
+    // number of slots that are handed out
+    std::atomic<size_t> live = 0;
+    // singly linked list of released slots that can be handed out again
+    void* free = nullptr;
+    // singly linked list of slots released since free was last refilled, which any thread pushes onto
+    std::atomic<void*> released = nullptr;
+    // links in the list of chunks of the same slot size that have room
+    HugePageChunk* prev = nullptr;
+    HugePageChunk* next = nullptr;
+    std::atomic<bool> has_room = false;
+    // true if the chunk was mapped with mmap, false if it came from operator new
+    bool mapped;
+
+    HugePageChunk(HugePageSizeClass* size_class, size_t slot_bytes, size_t first_slot, bool mapped) :
+            size_class(size_class), slot_bytes(slot_bytes), used(first_slot), mapped(mapped) {}
+
+    static HugePageChunk* owner(void const* p) {
+        return reinterpret_cast<HugePageChunk*>(reinterpret_cast<uintptr_t>(p) & ~(uintptr_t{chunk_bytes} - 1));
+    }
+
+    [[nodiscard]] bool full() const {
+        return free == nullptr && used + slot_bytes > chunk_bytes;
+    }
+
+    void* take() {
+        live.fetch_add(1, std::memory_order_relaxed);
+        if (free == nullptr) {
+            free = released.exchange(nullptr, std::memory_order_acquire);
+        }
+        if (free != nullptr) {
+            void* p = free;
+            free = *static_cast<void**>(p);
+            return p;
+        }
+        void* p = reinterpret_cast<char*>(this) + used;
+        used += slot_bytes;
+        return p;
+    }
+
+    void put(void* p) {
+        void* head = released.load(std::memory_order_relaxed);
+        do {
+            *static_cast<void**>(p) = head;
+        } while (!released.compare_exchange_weak(head, p, std::memory_order_seq_cst, std::memory_order_relaxed));
+    }
+
+    // gives up a slot that was put back, unless it is the last one handed out, which needs the mutex of the size
+    // class because the chunk may be returned to the OS
+    bool try_release_fast() {
+        size_t count = live.load(std::memory_order_relaxed);
+        while (count > 1) {
+            if (live.compare_exchange_weak(count, count - 1, std::memory_order_release, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/**
+ * The chunks of one slot size and alignment, with a mutex of their own so that allocations of different node sizes
+ * do not contend
+ */
+struct HugePageSizeClass {
+    std::mutex mutex{};
+    size_t slot_bytes;
+    size_t first_slot;
+    // the chunks that have room
+    HugePageChunk* available = nullptr;
+    // every chunk, including the full ones that are not in available
+    std::unordered_set<HugePageChunk*> all_chunks{};
+
+    HugePageSizeClass(size_t slot_bytes, size_t first_slot) : slot_bytes(slot_bytes), first_slot(first_slot) {}
+};
+
+/**
+ * Allocator for tree nodes backed by 2MB huge pages, which cuts the TLB misses of descending very large trees.
+ * Chunks are mapped with MAP_HUGETLB when the system has huge pages reserved. Otherwise they are aligned by hand and
+ * madvise(MADV_HUGEPAGE) asks for transparent huge pages. Without mmap chunks come from the aligned operator new.
+ * Each chunk holds nodes of one size and released nodes are reused. A chunk is returned to the OS once all of its
+ * nodes are released, except for one chunk per node size that is kept so that a tree which keeps allocating and
+ * releasing a node at a chunk boundary does not map and unmap a chunk every time.
+ * Each slot size and alignment has a HugePageSizeClass with its own mutex, which allocate locks. Nodes of persistent
+ * trees may be released by any thread, so release pushes the node onto a lock free list of its chunk, and only locks
+ * the mutex of the size class when the chunk was full or the node was the last one handed out from it.
+ * Nodes use this allocator when BPPTREE_HUGE_PAGE_NODES is defined, which must be done consistently in every
+ * translation unit.
+ */
+class HugePageArena {
+    std::mutex mutex{};
+    // the size classes by slot size and alignment, which are never removed so references to them stay valid
+    std::map<std::pair<size_t, size_t>, std::unique_ptr<HugePageSizeClass>> size_classes{};
+
+    static void* map_chunk(bool& mapped) {
+#if defined(__linux__)
+        mapped = true;
+#ifdef MAP_HUGETLB
+        void* p = mmap(nullptr, HugePageChunk::chunk_bytes, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            if ((reinterpret_cast<uintptr_t>(p) & (HugePageChunk::chunk_bytes - 1)) == 0) {
+                return p;
+            }
+            // the default huge page size is smaller than a chunk
+            munmap(p, HugePageChunk::chunk_bytes);
+        }
+#endif
+        // maps twice the chunk size so that an aligned chunk can be cut out of it
+        void* raw = mmap(nullptr, 2 * HugePageChunk::chunk_bytes, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw != MAP_FAILED) {
+            uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+            uintptr_t aligned = (start + HugePageChunk::chunk_bytes - 1) & ~(uintptr_t{HugePageChunk::chunk_bytes} - 1);
+            if (aligned != start) {
+                munmap(raw, aligned - start);
+            }
+            uintptr_t end = start + 2 * HugePageChunk::chunk_bytes;
+            if (aligned + HugePageChunk::chunk_bytes != end) {
+                munmap(reinterpret_cast<void*>(aligned + HugePageChunk::chunk_bytes), end - aligned - HugePageChunk::chunk_bytes);
+            }
+            void* p = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+            madvise(p, HugePageChunk::chunk_bytes, MADV_HUGEPAGE);
+#endif
+            return p;
+        }
+#endif
+        mapped = false;
+        return ::operator new(HugePageChunk::chunk_bytes, std::align_val_t(HugePageChunk::chunk_bytes));
+    }
+
+    static void free_chunk(HugePageChunk* chunk) {
+        bool mapped = chunk->mapped;
+        chunk->~HugePageChunk();
+#if defined(__linux__)
+        if (mapped) {
+            munmap(static_cast<void*>(chunk), HugePageChunk::chunk_bytes);
+            return;
+        }
+#endif
+        ::operator delete(static_cast<void*>(chunk), std::align_val_t(HugePageChunk::chunk_bytes));
+    }
+
+    static void unmap_chunk(HugePageChunk* chunk) {
+        chunk->size_class->all_chunks.erase(chunk);
+        free_chunk(chunk);
+    }
+
+    static void link(HugePageChunk* chunk) {
+        HugePageChunk*& head = chunk->size_class->available;
+        chunk->prev = nullptr;
+        chunk->next = head;
+        if (head != nullptr) {
+            head->prev = chunk;
+        }
+        head = chunk;
+        chunk->has_room = true;
+    }
+
+    static void unlink(HugePageChunk* chunk) {
+        if (chunk->prev != nullptr) {
+            chunk->prev->next = chunk->next;
+        } else {
+            chunk->size_class->available = chunk->next;
+        }
+        if (chunk->next != nullptr) {
+            chunk->next->prev = chunk->prev;
+        }
+        chunk->prev = nullptr;
+        chunk->next = nullptr;
+        chunk->has_room = false;
+    }
+
+public:
+    HugePageArena() = default;
+
+    HugePageArena(HugePageArena const&) = delete;
+
+    HugePageArena& operator=(HugePageArena const&) = delete;
+
+    /**
+     * Returns every chunk to the OS, including chunks with memory that was not released, so the arena must outlive
+     * all memory it handed out
+     */
+    ~HugePageArena() {
+        for (auto& [key, size_class] : size_classes) {
+            for (HugePageChunk* chunk : size_class->all_chunks) {
+                free_chunk(chunk);
+            }
+        }
+    }
+
+    /**
+     * @return the arena used by all nodes. it is never destroyed, so nodes of trees with static storage duration can
+     * still be released during program exit
+     */
+    static HugePageArena& instance() {
+        static auto* arena = new HugePageArena();
+        return *arena;
+    }
+
+    /**
+     * @return the size class of objects of the given size and alignment, which allocate can use without looking it
+     * up again
+     */
+    HugePageSizeClass& size_class(size_t bytes, size_t alignment) {
+        size_t align = alignment < alignof(void*) ? alignof(void*) : alignment;
+        size_t slot_bytes = (bytes + align - 1) & ~(align - 1);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& size_class = size_classes[{slot_bytes, align}];
+        if (size_class == nullptr) {
+            size_t first_slot = (sizeof(HugePageChunk) + align - 1) & ~(align - 1);
+            size_class = std::make_unique<HugePageSizeClass>(slot_bytes, first_slot);
+        }
+        return *size_class;
+    }
+
+    /**
+     * @return uninitialized memory for an object of the size class
+     */
+    void* allocate(HugePageSizeClass& size_class) {
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        if (size_class.available == nullptr) {
+            bool mapped = false;
+            void* p = map_chunk(mapped);
+            auto* chunk = new (p) HugePageChunk(&size_class, size_class.slot_bytes, size_class.first_slot, mapped);
+            size_class.all_chunks.insert(chunk);
+            link(chunk);
+        }
+        HugePageChunk* chunk = size_class.available;
+        void* ret = chunk->take();
+        if (chunk->full()) {
+            // a release that finds has_room still set does not link the chunk, so released is checked again after
+            // clearing it in case a slot was put back in between
+            chunk->has_room = false;
+            if (chunk->released.load() == nullptr) {
+                unlink(chunk);
+            } else {
+                chunk->has_room = true;
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * @return uninitialized memory for an object of the given size and alignment
+     */
+    void* allocate(size_t bytes, size_t alignment) {
+        return allocate(size_class(bytes, alignment));
+    }
+
+    /**
+     * Releases memory returned by allocate. The object in it must already have been destroyed.
+     */
+    void release(void* p) {
+        HugePageChunk* chunk = HugePageChunk::owner(p);
+        chunk->put(p);
+        if (chunk->has_room.load() && chunk->try_release_fast()) {
+            return;
+        }
+        HugePageSizeClass& size_class = *chunk->size_class;
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        if (!chunk->has_room) {
+            link(chunk);
+        }
+        if (chunk->live.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+                (chunk->prev != nullptr || chunk->next != nullptr)) {
+            // keeps the chunk only if it is the last one with room for its slot size
+            unlink(chunk);
+            unmap_chunk(chunk);
+        }
+    }
+
+    /**
+     * @return the number of chunks currently held by the arena
+     */
+    size_t chunks() {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t count = 0;
+        for (auto& [key, size_class] : size_classes) {
+            std::lock_guard<std::mutex> class_lock(size_class->mutex);
+            count += size_class->all_chunks.size();
+        }
+        return count;
+    }
+};
+} //end namespace bpptree::detail
@@ -123,9 +123,25 @@ struct IndexedInternalNode : public Parent {
         Parent::compute_delta_erase2(index, node_info);
     }
 
+    // finds the child holding search_val. whole groups of children are skipped first using the sum of their counts,
+    // which the compiler can compute with independent and vectorized additions, so the search takes one well
+    // predicted branch per group instead of one per child before finishing inside the group that holds search_val.
     auto find_index(SizeType search_val) const {
+        constexpr IndexType group = 4;
         std::tuple<IndexType, SizeType> ret(0, search_val);
         auto& [index, remainder] = ret;
+        while (index + group < this->length) {
+            SizeType sum{};
+            for (IndexType i = 0; i < group; ++i) {
+                sum = static_cast<SizeType>(sum + child_counts[index + i]);
+            }
+            if (sum < remainder) {
+                remainder -= sum;
+                index += group;
+            } else {
+                break;
+            }
+        }
         while (index < this->length - 1) {
             if (child_counts[index] < remainder) {
                 remainder -= child_counts[index];
@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <type_traits>
+#include <vector>
 #include "nodeptr.hpp"
 
 namespace bpptree::detail {
@@ -142,10 +145,36 @@ struct InternalNodeBase : public Parent {
 
     void compute_delta_erase2(IndexType, InfoType<NodeType>&) const {}
 
+    // called on the modified node after the child at index split and was replaced by two children. source is the node
+    // as it was before the modification, which is this node when modified in place.
+    void on_split_child2(NodeType const&, IndexType) {}
+
+    // returns how many of the internal_size + 1 children stay in the left node when the child at index splits and
+    // splits this node. run is positive if the recent splits of children of this node were ascending, which continue
+    // at index + 1, and negative if they were descending, which continue at index. the child where the run continues
+    // is kept as the last child of the left node so that the children it splits into fill that node.
+    static IndexType split_point(IndexType index, bool right_most, IndexType run) {
+        constexpr IndexType middle = (internal_size + 1) / 2;
+        if (run > 0) {
+            return std::clamp(index + 2, middle, IndexType(internal_size));
+        }
+        if (run < 0) {
+            return std::clamp(index + 1, IndexType(1), middle);
+        }
+        return right_most && index + 1 == internal_size ? index + 1 : middle;
+    }
+
+    // called on this node before the split of the child at index splits it into left and right. left is this node when
+    // splitting in place. returns the split point and may update the mixin state of left and right for the split.
+    IndexType split_point2(NodeType&, NodeType&, IndexType index, bool right_most) const {
+        return split_point(index, right_most, 0);
+    }
+
     template <typename R>
     void insert_replace(IndexType index, ReplaceType<ChildType>& replace, R&& do_replace, uint64_t& iter) noexcept(disable_exceptions) {
         ReplaceType<NodeType> result{};
         result.carry = replace.carry && index == this->length - 1;
+        result.copied = replace.copied || replace.delta.ptr_changed;
         set_index(iter, !replace.carry ? index : result.carry ? 0 : index + 1);
         compute_delta_replace(replace.delta, result.delta, index);
         if (this->persistent) {
@@ -175,6 +204,7 @@ struct InternalNodeBase : public Parent {
             }
         }
         node.length = this->length + 1;
+        node.self().on_split_child2(this->self(), index);
     }
 
     template <typename F>
@@ -208,7 +238,7 @@ struct InternalNodeBase : public Parent {
     }
 
     bool insert_split_split(InternalNodeBase& left, InternalNodeBase& right, IndexType index, SplitType<ChildType>& split, uint64_t& iter, bool right_most) noexcept(disable_exceptions) {
-        IndexType split_point = right_most && index + 1 == internal_size ? index + 1 : (internal_size + 1) / 2;
+        IndexType split_point = this->self().split_point2(left.self(), right.self(), index, right_most);
         for (IndexType i = this->length - 1; i > index; --i) {
             if (this->persistent) {
                 copy_element(left, right, i + 1, this->self(), i, split_point);
@@ -368,6 +398,8 @@ struct InternalNodeBase : public Parent {
     void erase(IndexType index, R&& do_replace, E&& do_erase, uint64_t& iter, bool right_most) noexcept(disable_exceptions) {
         if (this->length > 1) {
             ReplaceType<NodeType> replace{};
+            // the child at index was emptied and is dropped
+            replace.copied = true;
             compute_delta_erase(index, replace.delta);
             if (this->persistent) {
                 replace.delta.ptr = make_ptr<NodeType>();
@@ -442,8 +474,73 @@ struct InternalNodeBase : public Parent {
         return pointers[get_index(it)]->get_iter(it);
     }
 
+    // calls for_each on each child that holds part of [first, last), prefetching the next child before descending
+    // into the current one
+    template <typename F>
+    void for_each(uint64_t first, uint64_t last, bool starts_here, bool ends_here, F& f) const {
+        IndexType begin = starts_here ? get_index(first) : 0;
+        IndexType end = ends_here ? get_index(last) : this->length - 1;
+        for (IndexType i = begin; i <= end; ++i) {
+            if (i < end) {
+                __builtin_prefetch(&*pointers[i + 1], 0, 3);
+            }
+            pointers[i]->for_each(first, last, starts_here && i == begin, ends_here && i == end, f);
+        }
+    }
+
+    // calls update_chunks on each child that holds part of [first, last), copying the children that are persistent
+    // first, and then recomputes the mixin state this node keeps for those children. this node must not be persistent.
+    // returns whether any node was copied.
+    template <typename F>
+    bool update_chunks(uint64_t first, uint64_t last, bool starts_here, bool ends_here, F& f) {
+        IndexType begin = starts_here ? get_index(first) : 0;
+        IndexType end = ends_here ? get_index(last) : this->length - 1;
+        bool copied = false;
+        for (IndexType i = begin; i <= end; ++i) {
+            if (pointers[i]->persistent) {
+                pointers[i] = make_ptr<ChildType>(*pointers[i]);
+                copied = true;
+            }
+            copied |= pointers[i]->update_chunks(first, last, starts_here && i == begin, ends_here && i == end, f);
+            InfoType<ChildType> info(pointers[i], false);
+            set_element(i, info);
+        }
+        return copied;
+    }
+
+    /**
+     * Replaces every node that is distance levels below this node with copy(node), which must return a NodePtr to a
+     * copy of node. Calling this with distance 0, 1, ... copies the subtree top down in level order.
+     */
+    template <typename F>
+    void copy_level(F const& copy, int distance) {
+        for (IndexType i = 0; i < this->length; ++i) {
+            if (distance == 0) {
+                pointers[i] = copy(*pointers[i]);
+            } else if constexpr (depth > 2) {
+                pointers[i]->copy_level(copy, distance - 1);
+            }
+        }
+    }
+
+    // appends a pointer to each node of type T below this node to out, in order
+    template <typename T>
+    void collect_subtrees(std::vector<NodePtr<T>>& out) const {
+        for (IndexType i = 0; i < this->length; ++i) {
+            if constexpr (std::is_same_v<ChildType, T>) {
+                out.push_back(pointers[i]);
+            } else if constexpr (ChildType::depth > T::depth) {
+                pointers[i]->collect_subtrees(out);
+            }
+        }
+    }
+
+    // called once on each node just before it becomes persistent, while it is still only reachable from one tree
+    void on_make_persistent2() {}
+
     void make_persistent() {
         if (!this->persistent) {
+            this->self().on_make_persistent2();
             this->persistent = true;
             prefetch_children(true);
             for (IndexType i = 0; i < this->length; ++i) {
@@ -457,6 +554,24 @@ struct InternalNodeBase : public Parent {
         pointers[0]->seek_first(it);
     }
 
+    // returns how far into this subtree 'it' points, as a fraction of the values in it, assuming that every child
+    // holds the same number of values. only the lengths of the nodes on the path are known, and nothing keeps the
+    // other nodes equally full: splits of runs leave nodes with a single value and erase never rebalances. the
+    // result can be far off in trees with many erases, which only costs balance when it is used to divide work.
+    [[nodiscard]] double fraction(uint64_t it) const {
+        IndexType index = get_index(it);
+        return (static_cast<double>(index) + pointers[index]->fraction(it)) / static_cast<double>(this->length);
+    }
+
+    // points 'it' at the value that is about the given fraction of the way into this subtree
+    template <typename I>
+    void seek_fraction(I& it, double fraction) const {
+        double scaled = fraction * static_cast<double>(this->length);
+        auto index = std::clamp(static_cast<IndexType>(scaled), IndexType(0), IndexType(this->length - 1));
+        set_index(it.iter, index);
+        pointers[index]->seek_fraction(it, std::clamp(scaled - static_cast<double>(index), 0.0, 1.0));
+    }
+
     void seek_last(uint64_t& it) const {
         set_index(it, this->length - 1);
         pointers[this->length - 1]->seek_last(it);
@@ -485,6 +600,15 @@ struct InternalNodeBase : public Parent {
         return pointers[this->length - 1]->back();
     }
 
+    // returns the node just above the leaf that 'it' points into
+    [[nodiscard]] auto const* leaf_parent(uint64_t it) const {
+        if constexpr (depth == 2) {
+            return &this->self();
+        } else {
+            return pointers[get_index(it)]->leaf_parent(it);
+        }
+    }
+
     ssize advance(typename InternalNodeBase::template LeafNodeType<leaf_size> const*& leaf, uint64_t& it, ssize n) const {
         while (true) {
             n = pointers[get_index(it)]->advance(leaf, it, n);
@@ -30,7 +30,7 @@ struct IteratorBase<Tree, is_const, std::enable_if_t<IsTransientTree<Tree>::valu
     explicit IteratorBase(std::conditional_t<is_const, Tree const, Tree>& tree) : mod_count(tree.mod_count) {}
 };
 
-template <typename Value, typename Tree, typename LeafNode, bool is_const, bool reverse>
+template <typename Value, typename Tree, typename LeafNode, typename ParentNode, bool is_const, bool reverse>
 struct IteratorDetail : public IteratorBase<Tree, is_const> {
     using Parent = IteratorBase<Tree, is_const>;
 
@@ -47,6 +47,9 @@ struct IteratorDetail : public IteratorBase<Tree, is_const> {
     uint64_t iter = 0;
     TreeType* tree;
     mutable LeafNode const* leaf;
+    // the node above leaf, cached after descending from the root so that moving to a neighboring leaf usually does
+    // not have to descend again. it is only used while it still points to leaf.
+    mutable ParentNode const* parent = nullptr;
 
     explicit IteratorDetail(TreeType& tree) : Parent(tree), tree(&tree) {}
 
@@ -58,6 +61,9 @@ struct IteratorDetail : public IteratorBase<Tree, is_const> {
                     // advancing by 0 won't actually change tmp_iter.
                     uint64_t tmp_iter = iter;
                     root->advance(leaf, tmp_iter, 0);
+                    if constexpr (std::remove_reference_t<decltype(*root)>::depth > 1) {
+                        parent = root->leaf_parent(iter);
+                    }
                 });
                 this->mod_count = tree->mod_count;
             }
@@ -157,6 +163,37 @@ struct IteratorDetail : public IteratorBase<Tree, is_const> {
         return &get();
     }
 
+    // continues an advance that ran off the end of leaf from the cached parent and prefetches the leaf after the one
+    // it stops in. returns what is left to advance from the root when the advance also runs off the end of parent.
+    ssize advance_in_parent(ssize remainder) {
+        if (remainder == 0 || parent == nullptr) {
+            return remainder;
+        }
+        IndexType index = ParentNode::get_index(iter);
+        if (&*parent->pointers[index] != leaf) {
+            parent = nullptr;
+            return remainder;
+        }
+        bool backward = remainder < 0;
+        remainder = parent->advance(leaf, iter, remainder);
+        if (remainder > 0) {
+            // the advance may have skipped whole children without seeking into them, so the bits of iter below
+            // parent are moved to the last element of parent that the remainder counts from
+            parent->seek_last(iter);
+        } else if (remainder < 0) {
+            parent->seek_first(iter);
+        } else {
+            IndexType next = ParentNode::get_index(iter) + (backward ? -1 : 1);
+            if (next >= 0 && next < parent->length) {
+                auto const* bytes = reinterpret_cast<char const*>(&*parent->pointers[next]);
+                for (size_t offset = 0; offset < sizeof(LeafNode); offset += 64) {
+                    __builtin_prefetch(bytes + offset, 0, 3);
+                }
+            }
+        }
+        return remainder;
+    }
+
     void advance(ssize n) {
         n *= direction;
         ssize remainder;
@@ -166,7 +203,12 @@ struct IteratorDetail : public IteratorBase<Tree, is_const> {
             }
             iter = 0;
             if (n == 1) {
-                std::as_const(*tree).dispatch([this](auto const& root) { root->seek_begin(leaf, iter); });
+                std::as_const(*tree).dispatch([this](auto const& root) {
+                    root->seek_begin(leaf, iter);
+                    if constexpr (std::remove_reference_t<decltype(*root)>::depth > 1) {
+                        parent = root->leaf_parent(iter);
+                    }
+                });
                 if constexpr (is_transient_tree) {
                     this->mod_count = tree->mod_count;
                 }
@@ -174,9 +216,9 @@ struct IteratorDetail : public IteratorBase<Tree, is_const> {
             }
             remainder = n - 1;
         } else if constexpr (!is_transient_tree) { //NOLINT
-            remainder = leaf->advance(leaf, iter, n);
+            remainder = advance_in_parent(leaf->advance(leaf, iter, n));
         } else if (this->mod_count == tree->mod_count) {
-            remainder = leaf->advance(leaf, iter, n);
+            remainder = advance_in_parent(leaf->advance(leaf, iter, n));
         } else {
             remainder = n;
         }
@@ -189,6 +231,9 @@ struct IteratorDetail : public IteratorBase<Tree, is_const> {
                 if (r < 0) {
                     leaf = nullptr;
                     iter = rend;
+                    parent = nullptr;
+                } else if constexpr (std::remove_reference_t<decltype(*root)>::depth > 1) {
+                    parent = root->leaf_parent(iter);
                 }
             });
             if constexpr (is_transient_tree) {
@@ -8,12 +8,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include "uninitialized_array.hpp"
 #include "common.hpp"
+#include "span.hpp"
 
 namespace bpptree::detail {
 
-template <typename Parent, typename Value, auto leaf_size, bool disable_exceptions>
+template <typename Parent, typename Value, auto leaf_size, bool disable_exceptions, bool offset_leaves = false>
 struct LeafNodeBase : public Parent {
 
     using NodeType = typename Parent::SelfType;
@@ -34,7 +36,7 @@ struct LeafNodeBase : public Parent {
 
     static constexpr uint64_t it_clear = ~(it_mask << it_shift);
 
-    UninitializedArray<Value, leaf_size> values;
+    UninitializedArray<Value, leaf_size, offset_leaves> values;
 
     LeafNodeBase() = default;
 
@@ -84,22 +86,98 @@ struct LeafNodeBase : public Parent {
 
     void compute_delta_erase2(IndexType, InfoType&) const {}
 
+    // called on the modified node after a value has been inserted, assigned, or erased at index, or after the node
+    // was filled by a split. source is the node as it was before the modification, which is this node when modified
+    // in place. source may already have its new length but its mixin state is unchanged.
+    void on_insert2(NodeType const&, IndexType) {}
+
+    void on_assign2(IndexType) {}
+
+    void on_erase2(NodeType const&, IndexType) {}
+
+    void on_split2() {}
+
+    // returns how many of the leaf_size + 1 values stay in the left node when inserting at index splits this node.
+    // run is positive if the recent inserts into this node were ascending and negative if they were descending. a run
+    // is split next to the new value, leaving the values on the other side in a nearly full node, and continues into
+    // the node that has room, which is the right node because values between the two nodes are inserted there.
+    static IndexType split_point(IndexType index, bool right_most, IndexType run) {
+        constexpr IndexType middle = (leaf_size + 1) / 2;
+        if (run > 0) {
+            return std::clamp(index + 1, middle, IndexType(leaf_size));
+        }
+        if (run < 0) {
+            return std::clamp(index, IndexType(1), middle);
+        }
+        return right_most && index == leaf_size ? index : middle;
+    }
+
+    // called on this node before inserting at index splits it into left and right. left is this node when splitting
+    // in place. returns the split point and may update the mixin state of left and right for the split.
+    IndexType split_point2(NodeType&, NodeType&, IndexType index, bool right_most) const {
+        return split_point(index, right_most, 0);
+    }
+
+    static constexpr bool is_bitwise_copyable = UninitializedArray<Value, leaf_size>::is_bitwise_copyable;
+
+    static_assert(!offset_leaves || is_bitwise_copyable, "OffsetLeaves requires a bitwise copyable value type");
+
+    // makes room for a value at index in this node by moving whichever of the values before or after index are fewer
+    // by one position. if there is no room on that side the values are first recentered, so a run of inserts at
+    // either end of the node costs amortized O(1) per insert.
+    void open_gap(IndexType index) {
+        IndexType head = values.head;
+        IndexType length = this->length;
+        IndexType recenter = (leaf_size - length + 1) / 2;
+        if (index < length - index) {
+            if (head == 0) {
+                values.copy_bits(recenter, values, 0, length);
+                values.head = static_cast<uint16_t>(recenter);
+            }
+            values.copy_bits(-1, values, 0, index);
+            --values.head;
+        } else {
+            if (head + length == leaf_size) {
+                values.copy_bits(-recenter, values, 0, length);
+                values.head = static_cast<uint16_t>(head - recenter);
+            }
+            values.copy_bits(index + 1, values, index, length - index);
+        }
+    }
+
     template <typename... Args>
     void insert_no_split(LeafNodeBase& node, IndexType index, Args&&... args) noexcept(disable_exceptions) {
-        for (IndexType i = this->length; i > index; --i) {
-            if (this->persistent) {
-                node.values.set(i, node.length, values[i - 1]);
+        if constexpr (is_bitwise_copyable) {
+            if constexpr (offset_leaves) {
+                if (&node == this) {
+                    open_gap(index);
+                } else {
+                    node.values.copy_bits(index + 1, values, index, this->length - index);
+                }
             } else {
-                node.values.set(i, node.length, values.move(i - 1));
+                node.values.copy_bits(index + 1, values, index, this->length - index);
             }
-        }
-        node.values.emplace(index, node.length, std::forward<Args>(args)...);
-        if (this->persistent) {
-            for (IndexType i = 0; i < index; ++i) {
-                node.values.set(i, node.length, values[i]);
+            node.values.emplace(index, node.length, std::forward<Args>(args)...);
+            if (this->persistent) {
+                node.values.copy_bits(0, values, 0, index);
+            }
+        } else {
+            for (IndexType i = this->length; i > index; --i) {
+                if (this->persistent) {
+                    node.values.set(i, node.length, values[i - 1]);
+                } else {
+                    node.values.set(i, node.length, values.move(i - 1));
+                }
+            }
+            node.values.emplace(index, node.length, std::forward<Args>(args)...);
+            if (this->persistent) {
+                for (IndexType i = 0; i < index; ++i) {
+                    node.values.set(i, node.length, values[i]);
+                }
             }
         }
         node.length = this->length + 1;
+        node.self().on_insert2(this->self(), index);
     }
 
     template <typename T>
@@ -113,24 +191,45 @@ struct LeafNodeBase : public Parent {
 
     template <typename... Args>
     bool insert_split(LeafNodeBase& left, LeafNodeBase& right, IndexType index, uint64_t& iter, bool right_most, Args&&... args) noexcept(disable_exceptions) {
-        IndexType split_point = right_most && index == leaf_size ? index : (leaf_size + 1) / 2;
-        for (IndexType i = this->length; i > index; --i) {
-            if (this->persistent) {
-                set_element(left, right, i, split_point, values[i - 1]);
+        IndexType split_point = this->self().split_point2(left.self(), right.self(), index, right_most);
+        if constexpr (is_bitwise_copyable) {
+            // copies count old elements starting at src to their position after the split, where dst is their index
+            // in the combined sequence. left is this node when splitting in place, so elements that stay put are
+            // skipped
+            auto copy_range = [this, &left, &right, split_point](IndexType dst, IndexType src, IndexType count) {
+                IndexType left_count = std::min(std::max(split_point - dst, IndexType(0)), count);
+                // the right part is copied first because shifting the left part in place overwrites its source
+                right.values.copy_bits(dst + left_count - split_point, values, src + left_count, count - left_count);
+                if (left_count > 0 && (this->persistent || dst != src)) {
+                    left.values.copy_bits(dst, values, src, left_count);
+                }
+            };
+            copy_range(index + 1, index, this->length - index);
+            if (index < split_point) {
+                left.values.emplace(index, left.length, std::forward<Args>(args)...);
             } else {
-                set_element(left, right, i, split_point, std::move(values[i - 1]));
+                right.values.emplace(index - split_point, right.length, std::forward<Args>(args)...);
             }
-        }
-        if (index < split_point) {
-            left.values.emplace(index, left.length, std::forward<Args>(args)...);
+            copy_range(0, 0, index);
         } else {
-            right.values.emplace(index - split_point, right.length, std::forward<Args>(args)...);
-        }
-        for (IndexType i = this->persistent ? 0 : split_point; i < index; ++i) {
-            if (this->persistent) {
-                set_element(left, right, i, split_point, values[i]);
+            for (IndexType i = this->length; i > index; --i) {
+                if (this->persistent) {
+                    set_element(left, right, i, split_point, values[i - 1]);
+                } else {
+                    set_element(left, right, i, split_point, std::move(values[i - 1]));
+                }
+            }
+            if (index < split_point) {
+                left.values.emplace(index, left.length, std::forward<Args>(args)...);
             } else {
-                set_element(left, right, i, split_point, std::move(values[i]));
+                right.values.emplace(index - split_point, right.length, std::forward<Args>(args)...);
+            }
+            for (IndexType i = this->persistent ? 0 : split_point; i < index; ++i) {
+                if (this->persistent) {
+                    set_element(left, right, i, split_point, values[i]);
+                } else {
+                    set_element(left, right, i, split_point, std::move(values[i]));
+                }
             }
         }
         for (IndexType i = split_point; i < left.length; ++i) {
@@ -138,6 +237,8 @@ struct LeafNodeBase : public Parent {
         }
         left.length = static_cast<uint16_t>(split_point);
         right.length = static_cast<uint16_t>(leaf_size + 1 - split_point);
+        left.self().on_split2();
+        right.self().on_split2();
         if (index >= split_point) {
             set_index(iter, index - split_point);
             return false;
@@ -190,9 +291,11 @@ struct LeafNodeBase : public Parent {
             replace.delta.ptr = make_ptr<NodeType>(this->self());
             replace.delta.ptr_changed = true;
             replace.delta.ptr->values.emplace(index, replace.delta.ptr->length, std::forward<Args>(args)...);
+            replace.delta.ptr->on_assign2(index);
             do_replace(replace);
         } else {
             values.emplace_unchecked(index, std::forward<Args>(args)...);
+            this->self().on_assign2(index);
             do_replace(replace);
         }
     }
@@ -204,22 +307,40 @@ struct LeafNodeBase : public Parent {
     }
 
     bool erase(LeafNodeBase& node, IndexType index, uint64_t& iter, bool right_most) {
-        if (this->persistent) {
-            for (IndexType i = 0; i < index; ++i) {
-                node.values.set(i, node.length, values[i]);
-            }
-        }
-        for (IndexType i = index + 1; i < this->length; ++i) {
+        if constexpr (is_bitwise_copyable) {
             if (this->persistent) {
-                node.values.set(i - 1, node.length, values[i]);
+                node.values.copy_bits(0, values, 0, index);
+            }
+            if constexpr (offset_leaves) {
+                if (&node == this && index < this->length - 1 - index) {
+                    // close the gap by moving the values before index instead of the values after it
+                    values.copy_bits(1, values, 0, index);
+                    ++values.head;
+                } else {
+                    node.values.copy_bits(index, values, index + 1, this->length - index - 1);
+                }
             } else {
-                node.values.set(i - 1, node.length, values.move(i));
+                node.values.copy_bits(index, values, index + 1, this->length - index - 1);
+            }
+        } else {
+            if (this->persistent) {
+                for (IndexType i = 0; i < index; ++i) {
+                    node.values.set(i, node.length, values[i]);
+                }
+            }
+            for (IndexType i = index + 1; i < this->length; ++i) {
+                if (this->persistent) {
+                    node.values.set(i - 1, node.length, values[i]);
+                } else {
+                    node.values.set(i - 1, node.length, values.move(i));
+                }
             }
         }
         if (node.length == this->length) {
             node.values.destruct(this->length - 1);
         }
         node.length = this->length - 1;
+        node.self().on_erase2(this->self(), index);
         bool carry = index == node.length && !right_most;
         set_index(iter, carry ? 0 : index);
         return carry;
@@ -272,14 +393,60 @@ struct LeafNodeBase : public Parent {
         return values[get_index(it)];
     }
 
+    // calls f with each value of this node in [first, last). first and last are only used if the range starts or
+    // ends in this node.
+    template <typename F>
+    void for_each(uint64_t first, uint64_t last, bool starts_here, bool ends_here, F& f) const {
+        IndexType begin = starts_here ? get_index(first) : 0;
+        IndexType end = ends_here ? get_index(last) : this->length;
+        for (IndexType i = begin; i < end; ++i) {
+            f(values[i]);
+        }
+    }
+
+    // calls f with a mutable span over the values of this node in [first, last). first and last are only used if
+    // the range starts or ends in this node. this node must not be persistent. returns whether any node was copied,
+    // which is never the case for a leaf.
+    template <typename F>
+    bool update_chunks(uint64_t first, uint64_t last, bool starts_here, bool ends_here, F& f) {
+        IndexType begin = starts_here ? get_index(first) : 0;
+        IndexType end = ends_here ? get_index(last) : this->length;
+        if (end > begin) {
+            f(Span<Value>(&values[begin], static_cast<size_t>(end - begin)));
+            for (IndexType i = begin; i < end; ++i) {
+                this->self().on_assign2(i);
+            }
+        }
+        return false;
+    }
+
     void make_persistent() {
-        this->persistent = true;
+        if (!this->persistent) {
+            this->self().on_make_persistent2();
+            this->persistent = true;
+        }
     }
 
+    // called once on each node just before it becomes persistent, while it is still only reachable from one tree
+    void on_make_persistent2() {}
+
     void seek_first(uint64_t& it) const {
         clear_index(it);
     }
 
+    // returns how far into this node 'it' points, as a fraction of the values in this node
+    [[nodiscard]] double fraction(uint64_t it) const {
+        return this->length == 0 ? 0.0 : static_cast<double>(get_index(it)) / static_cast<double>(this->length);
+    }
+
+    // points 'it' at the value that is the given fraction of the way into this node. this node must not be empty.
+    template <typename I>
+    void seek_fraction(I& it, double fraction) const {
+        auto index = static_cast<IndexType>(fraction * static_cast<double>(this->length));
+        set_index(it.iter, std::clamp(index, IndexType(0), IndexType(this->length - 1)));
+        it.leaf = &this->self();
+    }
+
     void seek_last(uint64_t& it) const {
         set_index(it, this->length - 1);
     }
@@ -32,6 +32,13 @@ struct BPPTREE_CONCAT(BPPTREE_MINMAX_UPPER, Detail) {
 
         using InfoType = typename Parent::InfoType;
 
+        using NodeType = typename Parent::NodeType;
+
+        // index of the first min/max element in this leaf, kept up to date by the on_*2 hooks so that most
+        // modifications do not need to rescan the leaf. nodes are only modified before they become persistent so this
+        // is never written while another thread can read it.
+        uint16_t BPPTREE_CONCAT(BPPTREE_MINMAX, _index) = 0;
+
         template <typename T = Empty, bool enable_exclude = !std::is_same_v<T, Empty>>
         IndexType BPPTREE_CONCAT(BPPTREE_MINMAX, _excluding)(IndexType begin, IndexType end, T exclude_index = Empty::empty) const {
             IndexType min_max_index;
@@ -64,15 +71,87 @@ struct BPPTREE_CONCAT(BPPTREE_MINMAX_UPPER, Detail) {
             return BPPTREE_CONCAT(BPPTREE_MINMAX, _excluding)(0, this->length - 1, exclude_index);
         }
 
+        // returns the index of the first min/max element excluding exclude_index, using the cached index unless it
+        // is the one being excluded
+        template <typename T = Empty>
+        IndexType BPPTREE_CONCAT(BPPTREE_MINMAX, _cached)(T exclude_index = Empty::empty) const {
+            if (this->length == 0) {
+                return -1;
+            }
+            if constexpr (!std::is_same_v<T, Empty>) {
+                if (exclude_index == BPPTREE_CONCAT(BPPTREE_MINMAX, _index)) {
+                    return BPPTREE_CONCAT(BPPTREE_MINMAX, _excluding)(exclude_index);
+                }
+            }
+            return BPPTREE_CONCAT(BPPTREE_MINMAX, _index);
+        }
+
+        void BPPTREE_CONCAT(BPPTREE_MINMAX, _rescan)() {
+            BPPTREE_CONCAT(BPPTREE_MINMAX, _index) = static_cast<uint16_t>(BPPTREE_CONCAT(BPPTREE_MINMAX, _excluding)());
+        }
+
+        // makes index the cached min/max if the value at index is better than the value at current, or equal and
+        // before it
+        void BPPTREE_CONCAT(BPPTREE_MINMAX, _update)(IndexType index, IndexType current) {
+            decltype(auto) a = extractor(this->values[index]);
+            decltype(auto) b = extractor(this->values[current]);
+            bool better = comp(a, b) || (index < current && !comp(b, a));
+            BPPTREE_CONCAT(BPPTREE_MINMAX, _index) = static_cast<uint16_t>(better ? index : current);
+        }
+
+        void on_insert2(NodeType const& source, IndexType index) {
+            IndexType current = source.BPPTREE_CONCAT(BPPTREE_MINMAX, _index);
+            if (this->length == 1) {
+                BPPTREE_CONCAT(BPPTREE_MINMAX, _index) = 0;
+            } else {
+                BPPTREE_CONCAT(BPPTREE_MINMAX, _update)(index, current >= index ? current + 1 : current);
+            }
+            Parent::on_insert2(source, index);
+        }
+
+        void on_assign2(IndexType index) {
+            if (index == BPPTREE_CONCAT(BPPTREE_MINMAX, _index)) {
+                // the previous min/max was overwritten and may have gotten worse
+                BPPTREE_CONCAT(BPPTREE_MINMAX, _rescan)();
+            } else {
+                BPPTREE_CONCAT(BPPTREE_MINMAX, _update)(index, BPPTREE_CONCAT(BPPTREE_MINMAX, _index));
+            }
+            Parent::on_assign2(index);
+        }
+
+        void on_erase2(NodeType const& source, IndexType index) {
+            IndexType current = source.BPPTREE_CONCAT(BPPTREE_MINMAX, _index);
+            if (current == index) {
+                BPPTREE_CONCAT(BPPTREE_MINMAX, _rescan)();
+            } else {
+                BPPTREE_CONCAT(BPPTREE_MINMAX, _index) = static_cast<uint16_t>(current > index ? current - 1 : current);
+            }
+            Parent::on_erase2(source, index);
+        }
+
+        void on_split2() {
+            BPPTREE_CONCAT(BPPTREE_MINMAX, _rescan)();
+            Parent::on_split2();
+        }
+
         template <typename T, typename... Args>
         void compute_delta(T index, InfoType& node_info, Args const&... args) const {
-            IndexType min_max_index = BPPTREE_CONCAT(BPPTREE_MINMAX, _excluding)(index);
+            decltype(auto) a = extractor(args...);
+            if constexpr (!std::is_same_v<T, Empty>) {
+                // if the min/max is being replaced by a value that is at least as good then the rest of the leaf
+                // does not need to be scanned
+                if (index == BPPTREE_CONCAT(BPPTREE_MINMAX, _index) &&
+                        !comp(extractor(this->values[index]), a)) {
+                    node_info.BPPTREE_MINMAX = a;
+                    return;
+                }
+            }
+            IndexType min_max_index = BPPTREE_CONCAT(BPPTREE_MINMAX, _cached)(index);
             if (min_max_index >= 0) {
-                decltype(auto) a = extractor(args...);
                 decltype(auto) b = extractor(this->values[min_max_index]);
                 node_info.BPPTREE_MINMAX = comp(a, b) ? a : b;
             } else {
-                node_info.BPPTREE_MINMAX = extractor(args...);
+                node_info.BPPTREE_MINMAX = a;
             }
         }
 
@@ -89,7 +168,7 @@ struct BPPTREE_CONCAT(BPPTREE_MINMAX_UPPER, Detail) {
         }
 
         void compute_delta_erase2(IndexType index, InfoType& node_info) const {
-            IndexType min_max_index = BPPTREE_CONCAT(BPPTREE_MINMAX, _excluding)(index);
+            IndexType min_max_index = BPPTREE_CONCAT(BPPTREE_MINMAX, _cached)(index);
             if (min_max_index >= 0) {
                 node_info.BPPTREE_MINMAX = extractor(this->values[min_max_index]);
             }
@@ -102,8 +181,16 @@ struct BPPTREE_CONCAT(BPPTREE_MINMAX_UPPER, Detail) {
                 throw std::out_of_range("cannot call " BPPTREE_MINMAXSTR " on empty node");
             }
 #endif
-            IndexType min_max_index = BPPTREE_CONCAT(BPPTREE_MINMAX, _excluding)();
-            return extractor(this->values[min_max_index]);
+            return extractor(this->values[BPPTREE_CONCAT(BPPTREE_MINMAX, _index)]);
+        }
+
+        // the cached index is the first min/max in the leaf so it is also the first min/max of any range containing it
+        IndexType BPPTREE_CONCAT(BPPTREE_MINMAX, _range)(IndexType begin_index, IndexType end_index) const {
+            IndexType cached = BPPTREE_CONCAT(BPPTREE_MINMAX, _index);
+            if (begin_index <= cached && cached <= end_index) {
+                return cached;
+            }
+            return BPPTREE_CONCAT(BPPTREE_MINMAX, _excluding)(begin_index, end_index);
         }
 
         [[nodiscard]] KeyRef BPPTREE_MINMAX(uint64_t begin, uint64_t end) const {
@@ -114,7 +201,7 @@ struct BPPTREE_CONCAT(BPPTREE_MINMAX_UPPER, Detail) {
                 throw std::out_of_range("cannot call " BPPTREE_MINMAXSTR " on empty range");
             }
 #endif
-            IndexType min_max_index = BPPTREE_CONCAT(BPPTREE_MINMAX, _excluding)(begin_index, end_index);
+            IndexType min_max_index = BPPTREE_CONCAT(BPPTREE_MINMAX, _range)(begin_index, end_index);
             return extractor(this->values[min_max_index]);
         }
 
@@ -133,8 +220,7 @@ struct BPPTREE_CONCAT(BPPTREE_MINMAX_UPPER, Detail) {
                 throw std::out_of_range("cannot call " BPPTREE_MINMAXSTR " on empty node");
             }
 #endif
-            IndexType min_max_index = BPPTREE_CONCAT(BPPTREE_MINMAX, _excluding)();
-            this->set_index(it.iter, min_max_index);
+            this->set_index(it.iter, BPPTREE_CONCAT(BPPTREE_MINMAX, _index));
             it.leaf = &this->self();
         }
 
@@ -147,7 +233,7 @@ struct BPPTREE_CONCAT(BPPTREE_MINMAX_UPPER, Detail) {
                 throw std::out_of_range("cannot call " BPPTREE_MINMAXSTR " on empty range");
             }
 #endif
-            IndexType min_max_index = BPPTREE_CONCAT(BPPTREE_MINMAX, _excluding)(begin_index, end_index);
+            IndexType min_max_index = BPPTREE_CONCAT(BPPTREE_MINMAX, _range)(begin_index, end_index);
             this->set_index(it.iter, min_max_index);
             it.leaf = &this->self();
         }
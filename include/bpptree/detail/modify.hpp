@@ -35,11 +35,14 @@ struct ModifyTypes {
     struct DoReplace {
         TreeType& tree;
         NodePtr<NodeType>& root;
+        // true if any node on the modified path was replaced
+        bool copied = false;
 
         DoReplace(TreeType& tree, NodePtr<NodeType>& root) : tree(tree), root(root) {}
 
         template <typename ReplaceType>
         void operator()(ReplaceType&& replace) {
+            copied = replace.copied || replace.delta.ptr_changed;
             bool do_collapse = false;
             if (replace.delta.ptr_changed) {
                 if constexpr (NodeType::depth > 1) {
@@ -97,6 +100,7 @@ struct ModifyTypes {
 
         void operator()() {
             tree.root_variant = make_ptr<LeafNode>();
+            ++tree.epoch;
         }
     };
 
@@ -105,8 +109,9 @@ struct ModifyTypes {
         template <typename TreeType, typename NodeType, typename F, typename T, typename... Us>
         uint64_t operator()(TreeType& tree, NodePtr<NodeType>& root, F&& finder, T const& search_val, Us&&... params) {
             uint64_t ret = 0;
+            DoReplace<TreeType, NodeType> do_replace(tree, root);
             Operation()(*root, search_val, finder,
-                DoReplace<TreeType, NodeType>(tree, root),
+                do_replace,
                 DoSplit<TreeType, NodeType>(tree, root, ret),
                 DoErase<TreeType>(tree),
                 tree.tree_size,
@@ -114,7 +119,15 @@ struct ModifyTypes {
                 true,
                 std::forward<Us>(params)...
             );
-            ++tree.mod_count;
+            // an operation that only changes a value in place leaves every value in the same leaf at the same index, so
+            // iterators only have to find their leaf again if a node was copied on the way
+            if (!Operation::in_place || do_replace.copied) {
+                ++tree.mod_count;
+            }
+            // a node was copied or a child removed, which may have freed a leaf
+            if (do_replace.copied) {
+                ++tree.epoch;
+            }
             return ret;
         }
     };
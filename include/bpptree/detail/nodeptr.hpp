@@ -8,14 +8,21 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <type_traits>
+#include "arena.hpp"
+#ifdef BPPTREE_HUGE_PAGE_NODES
+#include "huge_page_arena.hpp"
+#endif
 
 namespace bpptree::detail {
 
-inline int allocations = 0;
-inline int deallocations = 0;
-inline int increments = 0;
-inline int decrements = 0;
+// atomic because nodes may be allocated by several threads at once
+inline std::atomic<int> allocations = 0;
+inline std::atomic<int> deallocations = 0;
+inline std::atomic<int> increments = 0;
+inline std::atomic<int> decrements = 0;
 
 inline void reset_counters() {
     allocations = 0;
@@ -40,7 +47,17 @@ class NodePtr {
         if (ptr != nullptr) {
             if (ptr->ref_count.fetch_sub(1, std::memory_order_release) == 1) {
                 std::atomic_thread_fence(std::memory_order_acquire);
-                delete ptr;
+                if (ptr->in_arena) {
+                    ptr->~PtrType();
+                    arena_release(ptr);
+                } else {
+#ifdef BPPTREE_HUGE_PAGE_NODES
+                    ptr->~PtrType();
+                    HugePageArena::instance().release(ptr);
+#else
+                    delete ptr;
+#endif
+                }
                 if constexpr (count_allocations) ++deallocations;
             }
             if constexpr (count_allocations) ++decrements;
@@ -113,6 +130,43 @@ NodePtr<PtrType> make_ptr(Ts&&... ts) noexcept(std::is_nothrow_constructible_v<P
         ++allocations;
         ++increments;
     }
+    // nodes allocated by make_ptr come from HugePageArena when BPPTREE_HUGE_PAGE_NODES is defined
+#ifdef BPPTREE_HUGE_PAGE_NODES
+    static_assert(sizeof(PtrType) + sizeof(HugePageChunk) <= HugePageChunk::chunk_bytes, "node is too large for a huge page chunk");
+    // the size class of PtrType is looked up once, so allocations only lock the mutex of the size class
+    static HugePageSizeClass& size_class = HugePageArena::instance().size_class(sizeof(PtrType), alignof(PtrType));
+    void* p = HugePageArena::instance().allocate(size_class);
+    if constexpr (std::is_nothrow_constructible_v<PtrType, Ts&&...>) {
+        return NodePtr<PtrType>(new (p) PtrType(std::forward<Ts>(ts)...));
+    } else {
+        // returns the memory to the arena if the constructor throws
+        struct Guard {
+            void* p;
+            ~Guard() {
+                if (p != nullptr) {
+                    HugePageArena::instance().release(p);
+                }
+            }
+        } guard{p};
+        auto* ptr = new (p) PtrType(std::forward<Ts>(ts)...);
+        guard.p = nullptr;
+        return NodePtr<PtrType>(ptr);
+    }
+#else
     return NodePtr<PtrType>(new PtrType(std::forward<Ts>(ts)...));
+#endif
+}
+
+template <typename PtrType, typename... Ts>
+NodePtr<PtrType> make_arena_ptr(Arena& arena, Ts&&... ts) {
+    static_assert(sizeof(PtrType) + sizeof(ArenaChunk) <= ArenaChunk::chunk_bytes, "node is too large for an arena chunk");
+    auto* ptr = new (arena.allocate(sizeof(PtrType), alignof(PtrType))) PtrType(std::forward<Ts>(ts)...);
+    ptr->in_arena = true;
+    Arena::commit(ptr);
+    if constexpr (count_allocations) {
+        ++allocations;
+        ++increments;
+    }
+    return NodePtr<PtrType>(ptr);
 }
 } //end namespace bpptree::detail
@@ -51,10 +51,12 @@ struct NodeTypesDetail {
         }
     };
 
+    static constexpr bool offset_leaves = (HasOffsetLeaves<Ts>::value || ... || false);
+
     template <typename Derived, auto leaf_size>
     struct LeafNodeMixin {
         template <typename Parent>
-        using LeafNodeBaseCurried = LeafNodeBase<Parent, Value, leaf_size, disable_exceptions>;
+        using LeafNodeBaseCurried = LeafNodeBase<Parent, Value, leaf_size, disable_exceptions, offset_leaves>;
         using Type = Chain<Derived,
                 Ts::template LeafNode...,
                 LeafNodeBaseCurried,
@@ -78,7 +80,7 @@ struct NodeTypesDetail {
     struct InternalNode : public InternalNodeMixin<InternalNode<leaf_size, internal_size, depth>, leaf_size, internal_size, depth>::Type {};
 
     template <typename Parent>
-    struct NodeBase : public Parent {
+    struct alignas(node_alignment == 0 ? alignof(std::atomic<uint32_t>) : node_alignment) NodeBase : public Parent {
         template <typename PtrType>
         using NodeInfoType = NodeInfo<PtrType>;
 
@@ -91,10 +93,12 @@ struct NodeTypesDetail {
         std::atomic<uint32_t> ref_count = 1;
         uint16_t length = 0;
         bool persistent = false;
+        // set by make_arena_ptr, tells NodePtr to release this node to its arena chunk instead of deleting it
+        bool in_arena = false;
 
         NodeBase() = default;
 
-        // ref_count and persistent are intentionally not copied
+        // ref_count, persistent, and in_arena are intentionally not copied
         NodeBase(NodeBase const& other) noexcept : Parent(other), length(other.length) {}
 
         // copy assignment is deleted because there is no scenario in which overwriting an existing node makes sense
@@ -112,12 +116,23 @@ struct NodeTypesDetail {
         }
     }
 
+    // true if one more value would not fit in leaf_node_bytes. when nodes are aligned their size is rounded up to the
+    // alignment, so the next larger node has to be checked directly.
+    template<int leaf_size>
+    static constexpr bool leaf_node_full() {
+        if constexpr (node_alignment == 0) {
+            return sizeof(LeafNode<leaf_size>) + sizeof(Value) > leaf_node_bytes;
+        } else {
+            return sizeof(LeafNode<leaf_size + 1>) > leaf_node_bytes;
+        }
+    }
+
     template<int leaf_size>
     static constexpr int get_leaf_node_size2() {
         constexpr ssize size = sizeof(LeafNode<leaf_size>);
         if constexpr (size > leaf_node_bytes) {
             return get_leaf_node_size3<leaf_size - 1>();
-        } else if constexpr (size + sizeof(Value) > leaf_node_bytes) {
+        } else if constexpr (leaf_node_full<leaf_size>()) {
             return leaf_size;
         } else {
             return get_leaf_node_size2<leaf_size + 1>();
@@ -146,12 +161,21 @@ struct NodeTypesDetail {
         }
     }
 
+    template<int internal_size>
+    static constexpr bool internal_node_full() {
+        if constexpr (node_alignment == 0) {
+            return sizeof(InternalNode<leaf_node_size, internal_size, 2>) + internal_element_size_lower_bound > internal_node_bytes;
+        } else {
+            return sizeof(InternalNode<leaf_node_size, internal_size + 1, 2>) > internal_node_bytes;
+        }
+    }
+
     template<int internal_size>
     static constexpr int get_internal_node_size2() {
         constexpr ssize size = sizeof(InternalNode<leaf_node_size, internal_size, 2>);
         if constexpr (size > internal_node_bytes) {
             return get_internal_node_size3<internal_size - 1>();
-        } else if constexpr (size + internal_element_size_lower_bound > internal_node_bytes) {
+        } else if constexpr (internal_node_full<internal_size>()) {
             return internal_size;
         } else {
             return get_internal_node_size2<internal_size + 1>();
@@ -14,7 +14,11 @@
 
 namespace bpptree::detail {
 
+// in_place is true for operations that only replace an existing value, which never moves values between or within
+// leaves
 struct Assign {
+    static constexpr bool in_place = true;
+
     template<typename N, typename T, typename F, typename R, typename S, typename E, typename... Args>
     void operator()(N& node, T const &search_val, F const& finder, R&& do_replace, S&&, E&&, size_t&, uint64_t& iter, bool, Args&&... args) {
         node.assign(search_val, finder, do_replace, iter, std::forward<decltype(args)>(args)...);
@@ -22,6 +26,8 @@ struct Assign {
 };
 
 struct Erase {
+    static constexpr bool in_place = false;
+
     template<typename N, typename T, typename F, typename R, typename S, typename E>
     void operator()(N& node, T const &search_val, F const& finder, R&& do_replace, S&&, E&& do_erase, size_t& size, uint64_t& iter, bool right_most) {
         node.erase(search_val, finder, do_replace, do_erase, size, iter, right_most);
@@ -29,6 +35,8 @@ struct Erase {
 };
 
 struct Insert {
+    static constexpr bool in_place = false;
+
     template<typename N, typename T, typename F, typename R, typename S, typename E, typename... Args>
     void operator()(N& node, T const &search_val, F const& finder, R&& do_replace, S&& do_split, E&&, size_t &size, uint64_t& iter, bool right_most, Args&&... args) {
         node.insert(search_val, finder, do_replace, do_split, size, iter, right_most, std::forward<decltype(args)>(args)...);
@@ -36,6 +44,8 @@ struct Insert {
 };
 
 struct Update {
+    static constexpr bool in_place = true;
+
     template<typename N, typename T, typename F, typename R, typename S, typename E, typename U>
     void operator()(N& node, T const &search_val, F const& finder, R&& do_replace, S&&, E&&, size_t&, uint64_t& iter, bool, U&& updater) {
         node.update(search_val, finder, do_replace, iter, updater);
@@ -43,6 +53,8 @@ struct Update {
 };
 
 struct Update2 {
+    static constexpr bool in_place = true;
+
     template<typename N, typename T, typename F, typename R, typename S, typename E, typename U>
     void operator()(N& node, T const &search_val, F const& finder, R&& do_replace, S&&, E&&, size_t&, uint64_t& iter, bool, U&& updater) {
         node.update2(search_val, finder, do_replace, iter, updater);
@@ -51,6 +63,8 @@ struct Update2 {
 
 template <DuplicatePolicy duplicate_policy>
 struct InsertOrAssign {
+    static constexpr bool in_place = false;
+
     template<typename N, typename T, typename F, typename R, typename S, typename E, typename... Args>
     void operator()(N& node, T const &search_val, F const& finder, R&& do_replace, S&& do_split, E&&,
             size_t &size, uint64_t& iter, bool right_most, Args&&... args) {
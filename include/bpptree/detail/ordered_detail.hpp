@@ -9,8 +9,10 @@
 #pragma once
 
 #include <cstdint>
+#include <cmath>
 #include <tuple>
 #include <algorithm>
+#include <limits>
 #include "helpers.hpp"
 #include "uninitialized_array.hpp"
 
@@ -28,7 +30,155 @@ struct HasDataPtr : std::false_type {};
 template <typename T>
 struct HasDataPtr<T, std::enable_if_t<std::is_pointer_v<decltype(std::declval<T const&>().data())>>> : std::true_type {};
 
-template <typename KeyValue, typename KeyValueExtractor, typename LessThan, bool binary_search>
+/**
+ * lower_bound over the n elements starting at first, where get(i) returns the key at index i.
+ * Each step halves the remaining range by adding either 0 or half to first based on a comparison, which compiles to
+ * arithmetic rather than a conditional jump, so every search does the same log2(n) steps regardless of the keys.
+ */
+template <typename Get, typename T, typename Comp>
+inline IndexType branchless_lower_bound(IndexType first, IndexType n, Get const& get, T const& search_val, Comp const& comp) {
+    if (n == 0) {
+        return first;
+    }
+    while (n > 1) {
+        IndexType half = n / 2;
+        first += static_cast<IndexType>(comp(get(first + half), search_val)) * half;
+        n -= half;
+    }
+    return first + static_cast<IndexType>(comp(get(first), search_val));
+}
+
+/**
+ * lower_bound over the n elements starting at first, where get(i) returns the key at index i.
+ * The position of search_val is estimated by linear interpolation between the first and last keys and then corrected
+ * by scanning from the estimate, so uniformly distributed keys are found in a few probes regardless of n. The scan
+ * gives up after about log2(n) steps and binary searches the rest of the range, so skewed keys stay O(log n).
+ * Falls back to branchless_lower_bound unless both the keys and search_val are arithmetic.
+ */
+template <typename Get, typename T, typename Comp>
+inline IndexType interpolation_lower_bound(IndexType first, IndexType n, Get const& get, T const& search_val, Comp const& comp) {
+    using K = std::remove_cv_t<std::remove_reference_t<decltype(get(first))>>;
+    if constexpr (!std::is_arithmetic_v<K> || !std::is_arithmetic_v<T>) {
+        return branchless_lower_bound(first, n, get, search_val, comp);
+    } else {
+        if (n == 0 || !comp(get(first), search_val)) {
+            return first;
+        }
+        IndexType last = first + n - 1;
+        if (comp(get(last), search_val)) {
+            return first + n;
+        }
+        // get(first) < search_val <= get(last) so the denominator is nonzero. comp may order keys in either direction
+        // but the ratio is positive either way. NaN or out of range estimates are clamped below.
+        auto const first_key = static_cast<double>(get(first));
+        double estimate = (static_cast<double>(search_val) - first_key) / (static_cast<double>(get(last)) - first_key)
+                * static_cast<double>(n - 1);
+        IndexType index = last;
+        if (!(estimate >= 1.0)) {
+            index = first + 1;
+        } else if (estimate < static_cast<double>(n - 1)) {
+            index = first + static_cast<IndexType>(estimate);
+        }
+        // the lower bound is in [lo, hi]. the estimate is corrected by at most about log2(n) steps so that skewed keys
+        // cost no more than a binary search of what is left
+        IndexType lo = first + 1;
+        IndexType hi = last;
+        IndexType steps = static_cast<IndexType>(std::numeric_limits<unsigned>::digits - __builtin_clz(static_cast<unsigned>(n)));
+        if (!comp(get(index - 1), search_val)) {
+            for (hi = index - 1; steps > 0; --steps, --hi) {
+                if (comp(get(hi - 1), search_val)) {
+                    return hi;
+                }
+            }
+        } else {
+            for (lo = index; steps > 0; --steps, ++lo) {
+                if (!comp(get(lo), search_val)) {
+                    return lo;
+                }
+            }
+        }
+        return branchless_lower_bound(lo, hi - lo + 1, get, search_val, comp);
+    }
+}
+
+/**
+ * Linear model of the position of a key within a node, fit by least squares when the node becomes persistent.
+ * max_error is the largest distance between a predicted and an actual position, so the lower bound of any key lies
+ * within max_error + 1 of its prediction as long as the model is monotonic. lower_bound checks the window boundaries
+ * against the keys anyway and searches the whole range if they do not bracket search_val.
+ */
+struct LinearModel {
+    double slope = 0;
+    double intercept = 0;
+    IndexType max_error = 0;
+
+    template <typename Get>
+    void fit(IndexType n, Get const& get) {
+        using K = std::remove_cv_t<std::remove_reference_t<decltype(get(0))>>;
+        if constexpr (std::is_arithmetic_v<K>) {
+            double mean_x = 0;
+            double mean_y = static_cast<double>(n - 1) / 2;
+            for (IndexType i = 0; i < n; ++i) {
+                mean_x += static_cast<double>(get(i));
+            }
+            mean_x = n > 0 ? mean_x / static_cast<double>(n) : 0;
+            double covariance = 0;
+            double variance = 0;
+            for (IndexType i = 0; i < n; ++i) {
+                double dx = static_cast<double>(get(i)) - mean_x;
+                covariance += dx * (static_cast<double>(i) - mean_y);
+                variance += dx * dx;
+            }
+            slope = variance > 0 ? covariance / variance : 0;
+            intercept = mean_y - slope * mean_x;
+            double error = 0;
+            for (IndexType i = 0; i < n; ++i) {
+                error = std::max(error, std::abs(slope * static_cast<double>(get(i)) + intercept - static_cast<double>(i)));
+            }
+            max_error = error < static_cast<double>(n) ? static_cast<IndexType>(std::ceil(error)) : n;
+        }
+    }
+
+    template <typename Get, typename T, typename Comp>
+    IndexType lower_bound(IndexType start, IndexType end, Get const& get, T const& search_val, Comp const& comp) const {
+        using K = std::remove_cv_t<std::remove_reference_t<decltype(get(start))>>;
+        if constexpr (std::is_arithmetic_v<K> && std::is_arithmetic_v<T>) {
+            double predicted = slope * static_cast<double>(search_val) + intercept;
+            // clamps NaN to 0
+            predicted = predicted >= 0 ? std::min(predicted, static_cast<double>(end)) : 0;
+            auto index = static_cast<IndexType>(predicted);
+            IndexType lo = std::max(start, index - max_error - 1);
+            IndexType hi = std::max(lo, std::min(end, index + max_error + 1));
+            if ((lo == start || comp(get(lo - 1), search_val)) && (hi == end || !comp(get(hi), search_val))) {
+                return branchless_lower_bound(lo, hi - lo, get, search_val, comp);
+            }
+        }
+        return branchless_lower_bound(start, end - start, get, search_val, comp);
+    }
+};
+
+/**
+ * The LinearModel of a node in SearchMode::learned, an empty base otherwise. The model is fit by on_make_persistent2
+ * each time the node is made persistent and is only used while the node is persistent. A copy of a persistent node
+ * starts out non-persistent, so the model it copied is ignored until the copy is made persistent and fit again.
+ */
+template <bool enabled>
+struct LinearModelStorage {
+    template <typename Get>
+    void fit_model(IndexType, Get const&) {}
+};
+
+template <>
+struct LinearModelStorage<true> {
+    LinearModel model{};
+
+    template <typename Get>
+    void fit_model(IndexType n, Get const& get) {
+        model.fit(n, get);
+    }
+};
+
+template <typename KeyValue, typename KeyValueExtractor, typename LessThan, SearchMode search_mode>
 struct OrderedDetail {
 private:
     static constexpr KeyValueExtractor extractor{};
@@ -36,26 +186,34 @@ private:
     static constexpr LessThan less_than{};
 
     using Key = std::remove_cv_t<std::remove_reference_t<decltype(extractor.get_key(std::declval<KeyValue const&>()))>>;
+
+    // non-arithmetic keys can't be modeled, so their nodes don't store a model and search them branchless
+    static constexpr bool learned = search_mode == SearchMode::learned && std::is_arithmetic_v<Key>;
 public:
     template <typename Parent>
-    struct LeafNode : public Parent {
+    struct LeafNode : public Parent, public LinearModelStorage<learned> {
 
         using InfoType = typename Parent::InfoType;
 
+        void on_make_persistent2() {
+            this->fit_model(this->length, [this](IndexType i) -> decltype(auto) { return extractor.get_key(this->values[i]); });
+            Parent::on_make_persistent2();
+        }
+
         template <typename Comp>
-        IndexType find_key_index(Key const& search_val, Comp const& comp) const {
+        IndexType find_key_index(Key const& search_val, Comp const& comp, IndexType start = 0) const {
             if constexpr (IsPtrOrSmartPtr<Key>::value) {
-                for (IndexType i = 0; i < this->length; ++i) {
+                for (IndexType i = start; i < this->length; ++i) {
                     __builtin_prefetch(&*extractor.get_key(this->values[i]), 0, 3);
                 }
             }
             if constexpr (HasDataPtr<Key>::value) {
-                for (IndexType i = 0; i < this->length; ++i) {
+                for (IndexType i = start; i < this->length; ++i) {
                     __builtin_prefetch(extractor.get_key(this->values[i]).data(), 0, 3);
                 }
             }
-            if constexpr (!binary_search) {
-                IndexType index = 0;
+            if constexpr (search_mode == SearchMode::linear) {
+                IndexType index = start;
                 while (index < this->length) {
                     if (comp(extractor.get_key(this->values[index]), search_val)) {
                         ++index;
@@ -64,10 +222,24 @@ public:
                     }
                 }
                 return index;
-            } else {
-                auto it = std::lower_bound(this->values.cbegin(), this->values.cbegin() + this->length, search_val,
+            } else if constexpr (search_mode == SearchMode::binary) {
+                auto it = std::lower_bound(this->values.cbegin() + start, this->values.cbegin() + this->length, search_val,
                                            [&comp](auto const& a, auto const& b) { return comp(extractor.get_key(a), b); });
                 return static_cast<IndexType>(std::distance(this->values.cbegin(), it));
+            } else {
+                auto get = [this](IndexType i) -> decltype(auto) { return extractor.get_key(this->values[i]); };
+                if constexpr (search_mode == SearchMode::branchless) {
+                    return branchless_lower_bound(start, this->length - start, get, search_val, comp);
+                } else if constexpr (search_mode == SearchMode::interpolation) {
+                    return interpolation_lower_bound(start, this->length - start, get, search_val, comp);
+                } else {
+                    if constexpr (learned) {
+                        if (this->persistent) {
+                            return this->model.lower_bound(start, this->length, get, search_val, comp);
+                        }
+                    }
+                    return branchless_lower_bound(start, this->length - start, get, search_val, comp);
+                }
             }
         }
 
@@ -167,6 +339,27 @@ public:
             return false;
         }
 
+        /**
+         * Looks up consecutive keys from the sorted range [first, last) that are <= bound (or all remaining keys if
+         * bound is nullptr), resuming each search where the previous one ended. Calls f(leaf, it, found) once per key.
+         */
+        template <typename InIt, typename F>
+        void seek_keys(uint64_t it, InIt& first, InIt const& last, Key const* bound, F&& f) const {
+            IndexType index = 0;
+            while (first != last && (bound == nullptr || !less_than(*bound, *first))) {
+                Key const& key = *first;
+                index = find_key_index(key, [](auto const& a, auto const& b) { return less_than(a, b); }, index);
+                bool found = false;
+                if (index < this->length) {
+                    decltype(auto) extracted = extractor.get_key(this->values[index]);
+                    found = !less_than(extracted, key) && !less_than(key, extracted);
+                }
+                this->set_index(it, index);
+                f(&this->self(), it, found);
+                ++first;
+            }
+        }
+
         bool contains(Key const& key) const {
             IndexType index = lower_bound_index(key);
             if (index < this->length) {
@@ -178,7 +371,7 @@ public:
     };
 
     template <typename Parent, auto internal_size>
-    struct InternalNode : public Parent {
+    struct InternalNode : public Parent, public LinearModelStorage<learned> {
 
         using NodeType = typename Parent::NodeType;
 
@@ -204,6 +397,11 @@ public:
             }
         }
 
+        void on_make_persistent2() {
+            this->fit_model(this->length - 1, [this](IndexType i) -> Key const& { return keys[i]; });
+            Parent::on_make_persistent2();
+        }
+
         void erase_element2(IndexType index) {
             keys.destruct(index);
             Parent::erase_element2(index);
@@ -259,19 +457,19 @@ public:
         }
 
         template <typename Comp>
-        IndexType find_key_index(Key const& search_val, Comp const& comp) const {
+        IndexType find_key_index(Key const& search_val, Comp const& comp, IndexType start = 0) const {
             if constexpr (IsPtrOrSmartPtr<Key>::value) {
-                for (IndexType i = 0; i < this->length; ++i) {
+                for (IndexType i = start; i < this->length; ++i) {
                     __builtin_prefetch(&*keys[i], 0, 3);
                 }
             }
             if constexpr (HasDataPtr<Key>::value) {
-                for (IndexType i = 0; i < this->length; ++i) {
+                for (IndexType i = start; i < this->length; ++i) {
                     __builtin_prefetch(keys[i].data(), 0, 3);
                 }
             }
-            if constexpr (!binary_search) {
-                IndexType index = 0;
+            if constexpr (search_mode == SearchMode::linear) {
+                IndexType index = start;
                 while (index < this->length - 1) {
                     if (comp(keys[index], search_val)) {
                         ++index;
@@ -280,12 +478,29 @@ public:
                     }
                 }
                 return index;
-            } else {
+            } else if constexpr (search_mode == SearchMode::binary) {
                 if (this->length == 0) {
                     return 0;
                 }
-                auto it = std::lower_bound(keys.cbegin(), keys.cbegin() + (this->length - 1), search_val, comp);
+                auto it = std::lower_bound(keys.cbegin() + start, keys.cbegin() + (this->length - 1), search_val, comp);
                 return static_cast<IndexType>(std::distance(keys.cbegin(), it));
+            } else {
+                if (this->length == 0) {
+                    return 0;
+                }
+                auto get = [this](IndexType i) -> Key const& { return keys[i]; };
+                if constexpr (search_mode == SearchMode::branchless) {
+                    return branchless_lower_bound(start, this->length - 1 - start, get, search_val, comp);
+                } else if constexpr (search_mode == SearchMode::interpolation) {
+                    return interpolation_lower_bound(start, this->length - 1 - start, get, search_val, comp);
+                } else {
+                    if constexpr (learned) {
+                        if (this->persistent) {
+                            return this->model.lower_bound(start, this->length - 1, get, search_val, comp);
+                        }
+                    }
+                    return branchless_lower_bound(start, this->length - 1 - start, get, search_val, comp);
+                }
             }
         }
 
@@ -328,6 +543,18 @@ public:
             return this->pointers[index]->seek_key(leaf, it, key, comp);
         }
 
+        template <typename InIt, typename F>
+        void seek_keys(uint64_t it, InIt& first, InIt const& last, Key const* bound, F&& f) const {
+            IndexType index = 0;
+            while (first != last && (bound == nullptr || !less_than(*bound, *first))) {
+                index = find_key_index(*first, [](auto const& a, auto const& b) { return less_than(a, b); }, index);
+                this->set_index(it, index);
+                // keys[index] is the last key in child index, so it bounds the keys that child can contain
+                Key const* child_bound = index == this->length - 1 ? bound : &keys[index];
+                this->pointers[index]->seek_keys(it, first, last, child_bound, f);
+            }
+        }
+
         bool contains(Key const& key) const {
             return this->pointers[lower_bound_index(key)]->contains(key);
         }
@@ -0,0 +1,207 @@
+//
+// B++ Tree: A B+ Tree library written in C++
+// Copyright (C) 2023 Jeff Plaisance
+//
+// This software is distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://boost.org/LICENSE_1_0.txt
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+namespace bpptree::detail {
+
+/**
+ * Uninitialized storage for count values of T, cut into parts the same way parallel_ranges cuts [0, count). The
+ * values of each part are constructed and destroyed on the threads of an executor, instead of all on the calling
+ * thread like the elements of a std::vector.
+ */
+template <typename T>
+class ParallelBuffer {
+    size_t count;
+    size_t parts;
+    T* data;
+    // whether the values of each part are constructed
+    std::vector<char> constructed;
+
+public:
+    ParallelBuffer(size_t count, size_t parts) :
+            count(count), parts(parts), data(std::allocator<T>().allocate(count)), constructed(parts) {}
+
+    ParallelBuffer(ParallelBuffer const&) = delete;
+
+    ParallelBuffer& operator=(ParallelBuffer const&) = delete;
+
+    ~ParallelBuffer() {
+        for (size_t part = 0; part < parts; ++part) {
+            if (constructed[part]) {
+                std::destroy(begin(part), end(part));
+            }
+        }
+        std::allocator<T>().deallocate(data, count);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return count;
+    }
+
+    [[nodiscard]] size_t part_count() const {
+        return parts;
+    }
+
+    [[nodiscard]] size_t bound(size_t part) const {
+        return count * part / parts;
+    }
+
+    [[nodiscard]] T* begin(size_t part) const {
+        return data + bound(part);
+    }
+
+    [[nodiscard]] T* end(size_t part) const {
+        return data + bound(part + 1);
+    }
+
+    [[nodiscard]] T* begin() const {
+        return data;
+    }
+
+    [[nodiscard]] T* end() const {
+        return data + count;
+    }
+
+    /**
+     * Calls init(begin, end, out) for each part in parallel, which must construct the values [begin, end) of the
+     * part at out, or none of them if it throws, like std::uninitialized_copy
+     */
+    template <typename Executor, typename Init>
+    void construct(Executor& executor, Init const& init) {
+        parallel_chunks(executor, parts, [this, &init](size_t part) {
+            init(bound(part), bound(part + 1), begin(part));
+            constructed[part] = 1;
+        });
+    }
+
+    /**
+     * Destroys the values of each part in parallel
+     */
+    template <typename Executor>
+    void destroy(Executor& executor) {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            parallel_chunks(executor, parts, [this](size_t part) {
+                if (constructed[part]) {
+                    std::destroy(begin(part), end(part));
+                    constructed[part] = 0;
+                }
+            });
+        }
+    }
+};
+
+/**
+ * @return how many of the first d values of the stable merge of [a, a + a_count) and [b, b + b_count) come from a,
+ * found with a binary search along the merge path
+ */
+template <typename It, typename Less>
+size_t merge_path(It a, size_t a_count, It b, size_t b_count, size_t d, Less const& less) {
+    using Diff = typename std::iterator_traits<It>::difference_type;
+    size_t lo = d > b_count ? d - b_count : 0;
+    size_t hi = std::min(d, a_count);
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        // a[i] comes before b[d - i - 1] unless it is greater, so i values of a are too few
+        if (less(b[static_cast<Diff>(d - i - 1)], a[static_cast<Diff>(i)])) {
+            hi = i;
+        } else {
+            lo = i + 1;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Stable sort of [first, last) on the threads of executor. One part per thread is moved into a buffer and sorted
+ * with std::stable_sort, and then neighboring runs are merged back and forth between the buffer and [first, last)
+ * in rounds. Each merge of a round is cut along its merge path into as many pieces of equal size as the runs it
+ * merges have parts, so every round merges all parts in parallel. Small ranges are sorted on the calling thread.
+ */
+template <typename It, typename Less, typename Executor>
+void parallel_stable_sort(It first, It last, Less const& less, Executor&& executor) {
+    using Diff = typename std::iterator_traits<It>::difference_type;
+    using T = typename std::iterator_traits<It>::value_type;
+    auto count = static_cast<size_t>(last - first);
+    size_t threads = parallel_threads(executor);
+    size_t parts = 1;
+    size_t rounds = 0;
+    while (parts < threads) {
+        parts *= 2;
+        ++rounds;
+    }
+    if (parts == 1 || count < parts * 4096) {
+        std::stable_sort(first, last, less);
+        return;
+    }
+    ParallelBuffer<T> buffer(count, parts);
+    buffer.construct(executor, [first](size_t begin, size_t end, T* out) {
+        std::uninitialized_move(first + static_cast<Diff>(begin), first + static_cast<Diff>(end), out);
+    });
+    parallel_chunks(executor, parts, [&buffer, &less](size_t part) {
+        std::stable_sort(buffer.begin(part), buffer.end(part), less);
+    });
+    // where each piece starts in the runs it merges from, which is found for all pieces before any are merged
+    // because merging moves values out of the runs
+    std::vector<size_t> splits(parts);
+    // merges the runs of width parts in from into runs of 2 * width parts in to
+    auto merge_round = [count, parts, &splits, &less, &executor](auto from, auto to, size_t width) {
+        auto bound = [count, parts](size_t part) { return count * part / parts; };
+        auto piece_range = [&bound, width](size_t piece) {
+            size_t left = piece / (2 * width) * (2 * width);
+            return std::make_tuple(bound(left), bound(left + width), bound(left + 2 * width), left);
+        };
+        parallel_chunks(executor, parts, [from, &splits, &bound, &piece_range, &less](size_t piece) {
+            auto [a_begin, b_begin, b_end, left] = piece_range(piece);
+            splits[piece] = merge_path(from + static_cast<Diff>(a_begin), b_begin - a_begin,
+                    from + static_cast<Diff>(b_begin), b_end - b_begin, bound(piece) - a_begin, less);
+        });
+        parallel_chunks(executor, parts, [from, to, &splits, &bound, &piece_range, &less, width](size_t piece) {
+            auto [a_begin, b_begin, b_end, left] = piece_range(piece);
+            bool last = piece + 1 == left + 2 * width;
+            size_t d_begin = bound(piece) - a_begin;
+            size_t d_end = bound(piece + 1) - a_begin;
+            size_t i_begin = splits[piece];
+            size_t i_end = last ? b_begin - a_begin : splits[piece + 1];
+            auto a = from + static_cast<Diff>(a_begin);
+            auto b = from + static_cast<Diff>(b_begin);
+            std::merge(
+                    std::make_move_iterator(a + static_cast<Diff>(i_begin)),
+                    std::make_move_iterator(a + static_cast<Diff>(i_end)),
+                    std::make_move_iterator(b + static_cast<Diff>(d_begin - i_begin)),
+                    std::make_move_iterator(b + static_cast<Diff>(d_end - i_end)),
+                    to + static_cast<Diff>(a_begin + d_begin),
+                    less);
+        });
+    };
+    size_t width = 1;
+    for (size_t round = 0; round < rounds; ++round, width *= 2) {
+        if (round % 2 == 0) {
+            merge_round(buffer.begin(), first, width);
+        } else {
+            merge_round(first, buffer.begin(), width);
+        }
+    }
+    if (rounds % 2 == 0) {
+        parallel_chunks(executor, parts, [&buffer, first](size_t part) {
+            std::move(buffer.begin(part), buffer.end(part), first + static_cast<Diff>(buffer.bound(part)));
+        });
+    }
+    buffer.destroy(executor);
+}
+} //end namespace bpptree::detail
@@ -0,0 +1,64 @@
+//
+// B++ Tree: A B+ Tree library written in C++
+// Copyright (C) 2023 Jeff Plaisance
+//
+// This software is distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://boost.org/LICENSE_1_0.txt
+//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bpptree::detail {
+
+/**
+ * A contiguous run of values inside a single leaf, in the spirit of C++20's std::span, which is not available in C++17.
+ * A Span is only valid until the tree it came from is next modified.
+ */
+template <typename T>
+class Span {
+    T* ptr = nullptr;
+    size_t count = 0;
+
+public:
+    using element_type = T;
+    using iterator = T*;
+
+    Span() = default;
+
+    Span(T* ptr, size_t count) : ptr(ptr), count(count) {}
+
+    [[nodiscard]] T* data() const {
+        return ptr;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return count;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return count == 0;
+    }
+
+    [[nodiscard]] T* begin() const {
+        return ptr;
+    }
+
+    [[nodiscard]] T* end() const {
+        return ptr + count;
+    }
+
+    [[nodiscard]] T& operator[](size_t index) const {
+        return ptr[index];
+    }
+
+    [[nodiscard]] T& front() const {
+        return ptr[0];
+    }
+
+    [[nodiscard]] T& back() const {
+        return ptr[count - 1];
+    }
+};
+} //end namespace bpptree::detail
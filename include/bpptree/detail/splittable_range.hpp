@@ -0,0 +1,81 @@
+//
+// B++ Tree: A B+ Tree library written in C++
+// Copyright (C) 2023 Jeff Plaisance
+//
+// This software is distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://boost.org/LICENSE_1_0.txt
+//
+
+#pragma once
+
+#include <utility>
+
+namespace bpptree::detail {
+
+/**
+ * A range [begin, end) of tree iterators that can be split in two near its middle, using the structure of the tree
+ * to find the middle without walking the range. It follows the range concept of work stealing schedulers such as
+ * TBB: empty, is_divisible, and a splitting constructor that takes the right half from another range.
+ * A SplittableRange is only valid until the tree it came from is next modified.
+ * @tparam It a forward iterator type of the tree
+ */
+template <typename It>
+class SplittableRange {
+    It first;
+    It last;
+
+    [[nodiscard]] It middle() const {
+        It ret = first.tree->split_range(first, last, 2)[0].end();
+        if (ret == first || ret == last) {
+            // only happens for ranges of a few values, where the estimate of the middle rounds to an end
+            ret = first;
+            ++ret;
+        }
+        return ret;
+    }
+
+public:
+    SplittableRange(It first, It last) : first(std::move(first)), last(std::move(last)) {}
+
+    /**
+     * Splits other in two, leaving the left half in other and taking the right half. other must be divisible.
+     * The second parameter is only a tag, such as tbb::split.
+     */
+    template <typename Split>
+    SplittableRange(SplittableRange& other, Split const&) : first(other.middle()), last(other.last) {
+        other.last = first;
+    }
+
+    [[nodiscard]] It const& begin() const {
+        return first;
+    }
+
+    [[nodiscard]] It const& end() const {
+        return last;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return first == last;
+    }
+
+    /**
+     * @return true if the range holds at least two values
+     */
+    [[nodiscard]] bool is_divisible() const {
+        if (empty()) {
+            return false;
+        }
+        It second = first;
+        ++second;
+        return second != last;
+    }
+
+    /**
+     * Splits this range in two, leaving the left half in this range. This range must be divisible.
+     * @return the right half
+     */
+    SplittableRange split() {
+        return SplittableRange(*this, 0);
+    }
+};
+} //end namespace bpptree::detail
@@ -10,10 +10,103 @@
 
 #include <tuple>
 #include <cstdint>
+#include <limits>
+#include <type_traits>
 #include "helpers.hpp"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace bpptree::detail {
 
+/**
+ * Finds the first index i in [0, n) where get(i) >= the remainder of target after subtracting get(0) through
+ * get(i - 1), or n if there is no such index. Returns the index and the remainder at that index.
+ */
+template <typename SumType, typename Get>
+inline std::tuple<IndexType, SumType> find_prefix_index(IndexType n, Get const& get, SumType target) {
+    std::tuple<IndexType, SumType> ret(0, target);
+    auto& [index, remainder] = ret;
+    while (index < n) {
+        SumType m = get(index);
+        if (m < remainder) {
+            remainder -= m;
+            ++index;
+        } else {
+            break;
+        }
+    }
+    return ret;
+}
+
+/**
+ * find_prefix_index of sums stored next to each other. For uint32_t sums SSE2 first skips 16 sums at a time while
+ * their total, added up in 64 bit lanes so that it can't wrap, is less than the remainder, which is one compare per
+ * 16 sums instead of one per sum. Then the 16 sums with the index are searched 4 at a time: the remainder at each
+ * lane is the remainder before the block minus an exclusive prefix scan of the lanes, all 4 lanes are compared with
+ * their remainders at once, and the index is the first lane whose bit is clear in the movemask of the compare.
+ * Skipping whole blocks relies on the sums before the index only adding up, so signed and floating point SumTypes
+ * use the loop.
+ */
+template <typename SumType>
+inline std::tuple<IndexType, SumType> find_prefix_index_contiguous(IndexType n, SumType const* sums, SumType target) {
+    IndexType index = 0;
+    SumType remainder = target;
+#if defined(__SSE2__) && defined(__x86_64__)
+    if constexpr (std::is_same_v<SumType, uint32_t>) {
+        auto load = [sums](IndexType i) { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(sums + i)); };
+        __m128i const zero = _mm_setzero_si128();
+        auto widen = [zero](__m128i m) {
+            return _mm_add_epi64(_mm_unpacklo_epi32(m, zero), _mm_unpackhi_epi32(m, zero));
+        };
+        for (; index + 16 <= n; index = static_cast<IndexType>(index + 16)) {
+            __m128i total = _mm_add_epi64(
+                    _mm_add_epi64(widen(load(index)), widen(load(index + 4))),
+                    _mm_add_epi64(widen(load(index + 8)), widen(load(index + 12))));
+            total = _mm_add_epi64(total, _mm_unpackhi_epi64(total, total));
+            auto block = static_cast<uint64_t>(_mm_cvtsi128_si64(total));
+            if (block >= remainder) {
+                break;
+            }
+            remainder = static_cast<SumType>(remainder - block);
+        }
+        if (index + 16 <= n) {
+            // the index is in this block, so all 4 blocks of 4 are compared without a branch between them
+            // flipping the sign bit makes the signed compare order unsigned values
+            __m128i const flip = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+            __m128i remaining = _mm_set1_epi32(static_cast<int32_t>(remainder));
+            alignas(16) SumType lanes[16];
+            unsigned mask = 0;
+            for (IndexType i = 0; i < 16; i += 4) {
+                __m128i m = load(index + i);
+                __m128i before = _mm_slli_si128(m, 4);
+                before = _mm_add_epi32(before, _mm_slli_si128(before, 4));
+                before = _mm_add_epi32(before, _mm_slli_si128(before, 8));
+                __m128i rem = _mm_sub_epi32(remaining, before);
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes + i), rem);
+                // the lanes where m < remainder, which the loop steps past
+                __m128i step = _mm_cmpgt_epi32(_mm_xor_si128(rem, flip), _mm_xor_si128(m, flip));
+                mask |= static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(step))) << i;
+                remaining = _mm_sub_epi32(remaining, _mm_shuffle_epi32(_mm_add_epi32(before, m), 0xff));
+            }
+            auto lane = static_cast<IndexType>(__builtin_ctz(~mask));
+            return {static_cast<IndexType>(index + lane), lanes[lane]};
+        }
+    }
+#endif
+    while (index < n) {
+        SumType m = sums[index];
+        if (m < remainder) {
+            remainder -= m;
+            ++index;
+        } else {
+            break;
+        }
+    }
+    return {index, remainder};
+}
+
 template <typename Parent, typename SumType, typename Extractor>
 struct SummedLeafNode : public Parent {
 
@@ -22,18 +115,16 @@ struct SummedLeafNode : public Parent {
     using InfoType = typename Parent::InfoType;
 
     auto find_index_forward(SumType target) const {
-        std::tuple<IndexType, SumType> ret(0, target);
-        auto& [index, remainder] = ret;
-        while (index < this->length) {
-            SumType m = extractor(this->values[index]);
-            if (m < remainder) {
-                remainder -= m;
-                ++index;
-            } else {
-                break;
-            }
+        if constexpr (std::is_same_v<Extractor, ValueExtractor> &&
+                std::is_same_v<std::remove_cv_t<std::remove_reference_t<decltype(this->values[0])>>, SumType>) {
+            // the values are the sums, so they can be searched in place
+            return find_prefix_index_contiguous(static_cast<IndexType>(this->length), &this->values[0], target);
+        } else {
+            return find_prefix_index(
+                    static_cast<IndexType>(this->length),
+                    [this](IndexType i) -> SumType { return extractor(this->values[i]); },
+                    target);
         }
-        return ret;
     }
 
     template <typename I>
@@ -145,17 +236,7 @@ struct SummedInternalNode : public Parent {
     }
 
     auto find_index_forward(SumType target) const {
-        std::tuple<IndexType, SumType> ret(0, target);
-        auto& [index, remainder] = ret;
-        while (index < this->length - 1) {
-            if (child_sums[index] < remainder) {
-                remainder -= child_sums[index];
-                ++index;
-            } else {
-                break;
-            }
-        }
-        return ret;
+        return find_prefix_index_contiguous(static_cast<IndexType>(this->length - 1), child_sums, target);
     }
 
     template <typename I>
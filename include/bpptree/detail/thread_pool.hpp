@@ -0,0 +1,217 @@
+//
+// B++ Tree: A B+ Tree library written in C++
+// Copyright (C) 2023 Jeff Plaisance
+//
+// This software is distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://boost.org/LICENSE_1_0.txt
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bpptree::detail {
+
+// chunks per thread that parallel work is cut into, so that threads that finish their chunks early can take chunks
+// from slower threads
+inline constexpr size_t parallel_chunks_per_thread = 8;
+
+/**
+ * @return the number of threads that can run at once, or 1 if that is not known
+ */
+inline size_t default_concurrency() {
+    size_t threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+}
+
+/**
+ * A fixed set of threads that run submitted tasks in the order they were submitted. It is the default executor of
+ * the parallel methods. Any other executor can be used instead, which must be callable with a
+ * std::function<void()> and run it eventually, on any thread including the calling one.
+ */
+class ThreadPool {
+    std::mutex mutex{};
+    std::condition_variable ready{};
+    std::deque<std::function<void()>> tasks{};
+    std::vector<std::thread> threads{};
+    bool stopping = false;
+
+    void run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    /**
+     * @param size the number of threads. the thread calling a parallel method works as well, so the default leaves
+     * one hardware thread for it
+     */
+    explicit ThreadPool(size_t size = default_concurrency() - 1) {
+        threads.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            threads.emplace_back([this]() { run(); });
+        }
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    /**
+     * Runs the tasks that were already submitted and then joins the threads
+     */
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    /**
+     * @return the pool used by the parallel methods when no executor is given
+     */
+    static ThreadPool& instance() {
+        static ThreadPool pool{};
+        return pool;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return threads.size();
+    }
+
+    void operator()(std::function<void()> task) {
+        if (threads.empty()) {
+            task();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        ready.notify_one();
+    }
+};
+
+template <typename Executor, typename = void>
+struct ExecutorThreads {
+    static size_t get(Executor const&) {
+        return default_concurrency() - 1;
+    }
+};
+
+template <typename Executor>
+struct ExecutorThreads<Executor, std::void_t<decltype(std::declval<Executor const&>().size())>> {
+    static size_t get(Executor const& executor) {
+        return static_cast<size_t>(executor.size());
+    }
+};
+
+/**
+ * @return the number of threads that work on a parallel call, which are the calling thread and the threads of the
+ * executor. executors that have no size() method are assumed to have one thread less than the hardware.
+ */
+template <typename Executor>
+size_t parallel_threads(Executor const& executor) {
+    return ExecutorThreads<std::decay_t<Executor>>::get(executor) + 1;
+}
+
+template <typename F>
+struct ParallelChunks {
+    F const* body;
+    size_t count;
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::mutex mutex{};
+    std::condition_variable finished{};
+    size_t done = 0;
+    std::exception_ptr error{};
+
+    ParallelChunks(F const* body, size_t count) : body(body), count(count) {}
+
+    // claims chunks until there are none left. a task that starts after the last chunk was claimed returns without
+    // touching body, so it is fine for it to run after parallel_chunks has returned.
+    void run() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            if (!failed.load(std::memory_order_relaxed)) {
+                try {
+                    (*body)(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    failed = true;
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++done == count) {
+                finished.notify_all();
+            }
+        }
+    }
+};
+
+/**
+ * Calls body(i) for each i in [0, count) on the calling thread and on parallel_threads(executor) - 1 tasks submitted
+ * to executor. Each thread claims the next chunk from a shared counter when it finishes one, so threads that get
+ * cheaper chunks take more of them. The calling thread works too, so this finishes even if the executor runs tasks
+ * late, or is busy with other calls to parallel_chunks. Rethrows the first exception thrown by body, after which
+ * the chunks that were not started yet are skipped.
+ */
+template <typename Executor, typename F>
+void parallel_chunks(Executor&& executor, size_t count, F const& body) {
+    if (count == 0) {
+        return;
+    }
+    auto state = std::make_shared<ParallelChunks<F>>(&body, count);
+    size_t tasks = std::min(parallel_threads(executor), count) - 1;
+    for (size_t i = 0; i < tasks; ++i) {
+        executor(std::function<void()>([state]() { state->run(); }));
+    }
+    state->run();
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state]() { return state->done == state->count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+/**
+ * Cuts [0, count) into parallel_chunks_per_thread ranges per thread and calls body(begin, end) for each of them with
+ * parallel_chunks
+ */
+template <typename Executor, typename F>
+void parallel_ranges(Executor&& executor, size_t count, F const& body) {
+    size_t chunks = std::min(count, parallel_threads(executor) * parallel_chunks_per_thread);
+    parallel_chunks(executor, chunks, [count, chunks, &body](size_t i) {
+        body(count * i / chunks, count * (i + 1) / chunks);
+    });
+}
+} //end namespace bpptree::detail
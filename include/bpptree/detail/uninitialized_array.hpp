@@ -10,16 +10,32 @@
 
 #include <new>
 #include <memory>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 namespace bpptree::detail {
 
+template <bool offset>
+struct UninitializedArrayHead {
+    static constexpr uint16_t head = 0;
+};
+
+template <>
+struct UninitializedArrayHead<true> {
+    // position in the storage of the element at index 0
+    uint16_t head = 0;
+};
+
 /**
  * Similar to std::array but contents are not default initialized.
  * The expectation is that the user tracks an index externally below which all elements have been initialized
  * and at or above no elements have been initialized.
+ * If offset is true, index 0 is stored at position head rather than at the start of the storage so that elements can
+ * be added or removed at the front by moving head. Only bitwise copyable types may move head.
  */
-template <typename T, size_t n>
-struct UninitializedArray {
+template <typename T, size_t n, bool offset = false>
+struct UninitializedArray : public UninitializedArrayHead<offset> {
 private:
     // storage for the array is implemented as a union with a single member which is an array of T of size n.
     // a union is used here because it prevents default construction of the array members.
@@ -45,10 +61,15 @@ private:
         return false;
     }
 public:
+    // true if elements can be copied to uninitialized memory and overwritten without running any constructors or
+    // destructors, which allows ranges of elements to be moved with memmove instead of one at a time
+    static constexpr bool is_bitwise_copyable =
+            std::is_trivially_copy_constructible_v<T> && std::is_trivially_destructible_v<T>;
+
     UninitializedArray() = default;
 
-    UninitializedArray(UninitializedArray const& other, size_t length) {
-        std::uninitialized_copy_n(other.un.data, length, un.data);
+    UninitializedArray(UninitializedArray const& other, size_t length) : UninitializedArrayHead<offset>(other) {
+        std::uninitialized_copy_n(other.cbegin(), length, begin());
     }
 
     UninitializedArray(UninitializedArray const& other) = delete;
@@ -58,12 +79,12 @@ public:
 
     template <typename I, std::enable_if_t<std::is_integral_v<I>, bool> = true>
     T& operator[](I const index) {
-        return un.data[index];
+        return un.data[this->head + index];
     }
 
     template <typename I, std::enable_if_t<std::is_integral_v<I>, bool> = true>
     T const& operator[](I const index) const {
-        return un.data[index];
+        return un.data[this->head + index];
     }
 
     template <typename I, std::enable_if_t<std::is_integral_v<I>, bool> = true>
@@ -90,12 +111,12 @@ public:
             (*this)[index] = std::forward<U>(u);
             return (*this)[index];
         }
-        return *new(un.data + index) T(std::forward<U>(u));
+        return *new(&(*this)[index]) T(std::forward<U>(u));
     }
 
     template <typename I, std::enable_if_t<std::is_integral_v<I>, bool> = true, typename... Us>
     T& initialize(I const index, Us&&... us) {
-        return *new(un.data + index) T(std::forward<Us>(us)...);
+        return *new(&(*this)[index]) T(std::forward<Us>(us)...);
     }
 
     template <typename I, typename L,
@@ -118,7 +139,7 @@ public:
             }
             (*this)[index].~T();
         }
-        return *new(un.data + index) T(std::forward<Us>(us)...);
+        return *new(&(*this)[index]) T(std::forward<Us>(us)...);
     }
 
     template <typename I, std::enable_if_t<std::is_integral_v<I>, bool> = true, typename... Us>
@@ -128,11 +149,30 @@ public:
             return (*this)[index];
         }
         (*this)[index].~T();
-        return *new(un.data + index) T(std::forward<Us>(us)...);
+        return *new(&(*this)[index]) T(std::forward<Us>(us)...);
+    }
+
+    /**
+     * Copies count elements starting at src_index in src to dst_index in this array. src may be this array and the
+     * ranges may overlap. dst_index may be negative if head leaves room for it. Only valid if is_bitwise_copyable is
+     * true.
+     */
+    template <typename I, typename J, typename C,
+            std::enable_if_t<std::is_integral_v<I>, bool> = true,
+            std::enable_if_t<std::is_integral_v<J>, bool> = true,
+            std::enable_if_t<std::is_integral_v<C>, bool> = true>
+    void copy_bits(I const dst_index, UninitializedArray const& src, J const src_index, C const count) noexcept {
+        static_assert(is_bitwise_copyable);
+        if (count > 0) {
+            std::memmove(
+                    static_cast<void*>(un.data + this->head + dst_index),
+                    static_cast<void const*>(src.un.data + src.head + src_index),
+                    static_cast<size_t>(count) * sizeof(T));
+        }
     }
 
     T* begin() {
-        return &un.data[0];
+        return &un.data[this->head];
     }
 
     T* end() {
@@ -140,7 +180,7 @@ public:
     }
 
     T const* cbegin() const {
-        return &un.data[0];
+        return &un.data[this->head];
     }
 
     T const* cend() const {
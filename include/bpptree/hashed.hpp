@@ -0,0 +1,243 @@
+//
+// B++ Tree: A B+ Tree library written in C++
+// Copyright (C) 2023 Jeff Plaisance
+//
+// This software is distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://boost.org/LICENSE_1_0.txt
+//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+#include "bpptree/detail/helpers.hpp"
+#include "bpptree/detail/nodeptr.hpp"
+
+namespace bpptree {
+namespace detail {
+
+// lookups answered by the index without descending from the root, counted when BPPTREE_TEST_COUNT_ALLOCATIONS is
+// defined so that tests can check the index is used
+inline std::atomic<int> hashed_index_hits = 0;
+
+/**
+ * Hashed mixin adds a hash index from key to leaf node to a Transient B++ tree with the Ordered mixin, so that
+ * at_key, contains, and find usually skip the descent from the root.
+ * The index remembers the leaf where each key that has been looked up was found. Inserts, erases and leaf splits do not
+ * invalidate it: at_key and contains search the remembered leaf for the key, and only descend from the root if the key
+ * has moved out of it, after which the index points to the new leaf. find also needs the path to the leaf, so it only
+ * uses the index while the tree is unmodified. The whole index is discarded when a leaf may have been removed from the
+ * tree, which happens when a leaf is emptied, when a snapshot is taken with persistent(), and on clear and the
+ * assign_* methods.
+ * Only lookups through a non-const Transient add to the index. Lookups through a const Transient only read it, so
+ * they may be called concurrently like the const methods of other trees. Persistent trees do not use the index.
+ * @tparam KeyValue the element type of the B++ tree
+ * @tparam KeyValueExtractor the same extractor used by the Ordered mixin
+ * @tparam Hash a hash function for the key type, or void to use std::hash. Keys are compared with ==, which must be
+ * consistent with the Ordered mixin's comparator
+ */
+template <typename KeyValue, typename KeyValueExtractor = PairExtractor<0>, typename Hash = void>
+struct Hashed {
+private:
+    static constexpr KeyValueExtractor extractor{};
+
+    using Key = std::remove_cv_t<std::remove_reference_t<decltype(extractor.get_key(std::declval<KeyValue const&>()))>>;
+
+    using HashType = std::conditional_t<std::is_void_v<Hash>, std::hash<Key>, Hash>;
+public:
+    static constexpr size_t sizeof_hint() {
+        return 0;
+    }
+
+    template <typename Parent>
+    struct LeafNode : public Parent {};
+
+    template <typename Parent, auto internal_size>
+    struct InternalNode : public Parent {};
+
+    template <typename Parent>
+    struct NodeInfo : public Parent {
+        NodeInfo() = default;
+
+        template <typename P>
+        NodeInfo(P const& p, const bool changed) : Parent(p, changed) {}
+    };
+
+    template <typename Parent>
+    struct Shared : public Parent {
+        template <typename... Us>
+        explicit Shared(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+    };
+
+    template <typename Parent>
+    struct Transient : public Parent {
+        template <typename... Us>
+        explicit Transient(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+
+    private:
+        struct Locator {
+            void const* leaf;
+            uint64_t iter;
+            // the tree's mod_count when the key was found. while it is unchanged iter is still the path to the key.
+            uint64_t mod_count;
+            // the leaf was shared with a snapshot, so any modification may have replaced it with a copy
+            bool persistent;
+        };
+
+        std::unordered_map<Key, Locator, HashType> locators{};
+
+        // the tree's leaf epoch when the locators were found. every leaf they point to is alive and part of the tree
+        // while it is unchanged.
+        uint64_t locators_epoch = 0;
+
+        template <typename It>
+        using LeafType = std::remove_const_t<std::remove_pointer_t<decltype(std::declval<It&>().leaf)>>;
+
+        /**
+         * Points it, which must have been constructed from this tree, at key if key is in the index. If value_only, the
+         * path in it may be out of date above the leaf, so it may only be dereferenced.
+         * @return true if key was found in the index
+         */
+        template <typename It>
+        bool seek_indexed(Key const& key, It& it, bool value_only) const {
+            if (locators_epoch != this->self().leaf_epoch()) {
+                return false;
+            }
+            auto found = locators.find(key);
+            if (found == locators.end()) {
+                return false;
+            }
+            Locator const& locator = found->second;
+            auto const* leaf = static_cast<LeafType<It> const*>(locator.leaf);
+            uint64_t iter = locator.iter;
+            if (locator.mod_count != it.mod_count) {
+                if (!value_only || locator.persistent) {
+                    return false;
+                }
+                // the key may have moved within the leaf, or out of it if the leaf was split or the key erased
+                IndexType index = leaf->lower_bound_index(key);
+                if (index >= leaf->length || !(extractor.get_key(leaf->values[index]) == key)) {
+                    return false;
+                }
+                LeafType<It>::set_index(iter, index);
+            }
+            if constexpr (count_allocations) ++hashed_index_hits;
+            it.leaf = leaf;
+            it.iter = iter;
+            return true;
+        }
+
+        /**
+         * Points it, which must have been constructed from this tree, at key and adds key to the index if it is in
+         * the tree. If value_only, it may only be dereferenced, as for seek_indexed.
+         * @return true if key is in the tree
+         */
+        template <typename It>
+        bool seek_hashed(Key const& key, It& it, bool value_only) {
+            if (seek_indexed(key, it, value_only)) {
+                return true;
+            }
+            uint64_t epoch = this->self().leaf_epoch();
+            if (locators_epoch != epoch || locators.size() > 2 * this->size() + 64) {
+                // the leaves may be gone, or many of the keys have been erased
+                locators.clear();
+                locators_epoch = epoch;
+            }
+            it = this->Parent::find_const(key);
+            if (LeafType<It>::get_index(it.iter) < it.leaf->length) {
+                locators.insert_or_assign(key, Locator{it.leaf, it.iter, it.mod_count, it.leaf->persistent});
+                return true;
+            }
+            locators.erase(key);
+            return false;
+        }
+
+    public:
+        [[nodiscard]] decltype(auto) at_key(Key const& key) const {
+            typename Parent::const_iterator it(this->self());
+            if (!seek_indexed(key, it, true)) {
+                return Parent::at_key(key);
+            }
+            return extractor.get_value(it.leaf->get_iter(it.iter));
+        }
+
+        [[nodiscard]] decltype(auto) at_key(Key const& key) {
+            typename Parent::const_iterator it(this->self());
+            if (!seek_hashed(key, it, true)) {
+                // seek_hashed already descended, so only the error is left
+#ifdef BPPTREE_SAFETY_CHECKS
+                throw std::logic_error("key not found!");
+#else
+                return Parent::at_key(key);
+#endif
+            }
+            return extractor.get_value(it.leaf->get_iter(it.iter));
+        }
+
+        [[nodiscard]] bool contains(Key const& key) const {
+            typename Parent::const_iterator it(this->self());
+            return seek_indexed(key, it, true) || Parent::contains(key);
+        }
+
+        [[nodiscard]] bool contains(Key const& key) {
+            typename Parent::const_iterator it(this->self());
+            return seek_hashed(key, it, true);
+        }
+
+        /**
+         * @return an iterator pointing to the element with key 'key'
+         */
+        [[nodiscard]] typename Parent::iterator find(Key const& key) {
+            typename Parent::const_iterator it(this->self());
+            typename Parent::iterator ret(this->self());
+            seek_hashed(key, it, false);
+            ret.leaf = it.leaf;
+            ret.iter = it.iter;
+            return ret;
+        }
+
+        /**
+         * @return a const_iterator pointing to the element with key 'key'
+         */
+        [[nodiscard]] typename Parent::const_iterator find_const(Key const& key) const {
+            typename Parent::const_iterator ret(this->self());
+            if (!seek_indexed(key, ret, false)) {
+                return Parent::find_const(key);
+            }
+            return ret;
+        }
+
+        /**
+         * @return a const_iterator pointing to the element with key 'key'
+         */
+        [[nodiscard]] typename Parent::const_iterator find(Key const& key) const {
+            return find_const(key);
+        }
+    };
+
+    template <typename Parent>
+    struct Persistent : public Parent {
+        template <typename... Us>
+        explicit Persistent(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+    };
+};
+
+template <typename KeyValueExtractor = PairExtractor<0>, typename Hash = void>
+struct HashedBuilder {
+    template <typename T>
+    using extractor = HashedBuilder<T, Hash>;
+
+    template <typename T>
+    using hash = HashedBuilder<KeyValueExtractor, T>;
+
+    template <typename Value>
+    using build = Hashed<Value, KeyValueExtractor, Hash>;
+};
+} //end namespace detail
+using detail::Hashed;
+using detail::HashedBuilder;
+} //end namespace bpptree
@@ -0,0 +1,73 @@
+//
+// B++ Tree: A B+ Tree library written in C++
+// Copyright (C) 2023 Jeff Plaisance
+//
+// This software is distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://boost.org/LICENSE_1_0.txt
+//
+
+#pragma once
+
+#include "bpptree/detail/helpers.hpp"
+
+namespace bpptree {
+namespace detail {
+
+/**
+ * OffsetLeaves mixin stores the values in each leaf starting at a movable offset instead of at the start of the leaf.
+ * Inserting or erasing a value in a leaf then moves whichever of the values before or after it are fewer, so
+ * push_front, pop_front, push_back, and pop_back are all amortized O(1) within a leaf and random inserts move half as
+ * many values on average. This is useful for trees used as deques or FIFO queues. Values stay contiguous within a
+ * leaf, so lookups and iteration are unaffected apart from the cost of adding the offset.
+ * Requires a value type that is trivially copy constructible and trivially destructible.
+ * @tparam Value the value type of the B++ tree
+ */
+template <typename Value>
+struct OffsetLeaves {
+    static constexpr bool offset_leaves = true;
+
+    static constexpr size_t sizeof_hint() {
+        return 0;
+    }
+
+    template <typename Parent>
+    struct LeafNode : public Parent {};
+
+    template <typename Parent, auto internal_size>
+    struct InternalNode : public Parent {};
+
+    template <typename Parent>
+    struct NodeInfo : public Parent {
+        NodeInfo() = default;
+
+        template <typename P>
+        NodeInfo(P const& p, const bool changed) : Parent(p, changed) {}
+    };
+
+    template <typename Parent>
+    struct Shared : public Parent {
+        template <typename... Us>
+        explicit Shared(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+    };
+
+    template <typename Parent>
+    struct Transient : public Parent {
+        template <typename... Us>
+        explicit Transient(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+    };
+
+    template <typename Parent>
+    struct Persistent : public Parent {
+        template <typename... Us>
+        explicit Persistent(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+    };
+};
+
+struct OffsetLeavesBuilder {
+    template <typename Value>
+    using build = OffsetLeaves<Value>;
+};
+} //end namespace detail
+using detail::OffsetLeaves;
+using detail::OffsetLeavesBuilder;
+} //end namespace bpptree
@@ -8,9 +8,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <tuple>
 #include <stdexcept>
 #include <optional>
+#include <vector>
 
 #include "bpptree/detail/helpers.hpp"
 #include "bpptree/detail/uninitialized_array.hpp"
@@ -38,6 +40,8 @@ inline constexpr auto find_key_index_checked = [](auto const& node, auto const&
  * @tparam BinarySearch std::true_type to use binary search within internal and leaf nodes, std::false_type to use
  * linear search. linear search is typically faster for value types, but binary search is likely to be faster if
  * comparing two keys requires an indirection or if the nodes are exceptionally large.
+ * SearchPolicy<SearchMode::branchless> uses a binary search without data dependent branches, which avoids branch
+ * mispredictions on random keys and is usually the fastest choice for cheap to compare keys in large nodes.
  */
 template <typename KeyValue, typename KeyValueExtractor = PairExtractor<0>, typename LessThan = MinComparator, typename BinarySearch = std::false_type>
 struct Ordered {
@@ -50,7 +54,7 @@ private:
 
     static constexpr auto less_than_or_equal = [](auto const& a, auto const& b){ return !less_than(b, a); };
 
-    static constexpr bool binary_search = BinarySearch::value;
+    static constexpr SearchMode search_mode = search_mode_v<BinarySearch>;
 
     using Key = std::remove_cv_t<std::remove_reference_t<decltype(extractor.get_key(std::declval<KeyValue const&>()))>>;
 
@@ -58,7 +62,7 @@ private:
 
     using Value = std::remove_cv_t<std::remove_reference_t<GetValue>>;
 
-    using Detail = OrderedDetail<KeyValue, KeyValueExtractor, LessThan, binary_search>;
+    using Detail = OrderedDetail<KeyValue, KeyValueExtractor, LessThan, search_mode>;
 public:
     static constexpr size_t sizeof_hint() {
         return sizeof(Key);
@@ -75,6 +79,10 @@ public:
 
     template <typename Parent>
     struct Shared : public Parent {
+        using key_compare = LessThan;
+
+        using key_extractor = KeyValueExtractor;
+
         template <typename... Us>
         explicit Shared(Us&&... us) : Parent(std::forward<Us>(us)...) {}
 
@@ -182,6 +190,58 @@ public:
                 [&key](auto const& root) { return root->contains(key); }
             );
         }
+
+    private:
+        template <typename It, typename InIt, typename OutIt>
+        OutIt find_sorted_internal(It const& it, InIt first, InIt const& last, OutIt out) const {
+            It end(it);
+            this->self().dispatch(
+                    [&it, &end, &first, &last, &out](auto& root) {
+                        root->seek_end(end.leaf, end.iter);
+                        root->seek_keys(0, first, last, nullptr, [&it, &end, &out](auto const* leaf, uint64_t iter, bool found) {
+                            if (found) {
+                                It ret(it);
+                                ret.leaf = leaf;
+                                ret.iter = iter;
+                                *out++ = ret;
+                            } else {
+                                *out++ = end;
+                            }
+                        });
+                    }
+            );
+            return out;
+        }
+
+    public:
+        /**
+         * Looks up every key in the range [first, last) in a single pass over the tree. Searches resume from where
+         * the previous key was found, so k keys cost O(k + nodes visited) instead of O(k log N).
+         * The keys must be sorted according to the comparator of the tree. Duplicate keys are allowed.
+         * For each key, writes an iterator pointing to the element with that key (or end() if there is no such
+         * element) to 'out', in the same order as the keys.
+         * @return 'out' advanced past the last iterator written
+         */
+        template <typename InIt, typename OutIt>
+        OutIt find_sorted(InIt first, InIt last, OutIt out) {
+            return find_sorted_internal(typename Parent::iterator(this->self()), first, last, out);
+        }
+
+        /**
+         * Same as find_sorted but writes const_iterators to 'out'
+         */
+        template <typename InIt, typename OutIt>
+        OutIt find_sorted_const(InIt first, InIt last, OutIt out) const {
+            return find_sorted_internal(typename Parent::const_iterator(this->self()), first, last, out);
+        }
+
+        /**
+         * Same as find_sorted but writes const_iterators to 'out'
+         */
+        template <typename InIt, typename OutIt>
+        OutIt find_sorted(InIt first, InIt last, OutIt out) const {
+            return find_sorted_const(first, last, out);
+        }
     };
 
     template <typename Parent>
@@ -344,6 +404,227 @@ public:
         [[nodiscard]] GetValue operator[](Key const& key) const {
             return this->at_key(key);
         }
+
+        /**
+         * WriteBuffer collects inserts, assigns, and erases for a Transient and applies them to the tree in batches.
+         * Pending writes are kept in sorted runs so that the buffer can look them up in O(log^2 capacity), and are
+         * applied in key order when the buffer is full, skipping writes that a later write to the same key replaced.
+         * A batch that is large relative to the tree is merged with the values of the tree in one pass that rebuilds
+         * the tree bottom up with assign_parts. A smaller batch is applied one key at a time, where consecutive writes
+         * descend the same path through the tree while it is still in cache instead of each one missing on every
+         * level. This makes random writes much cheaper on trees that are larger than the cache. Rebuilding copies
+         * every value, so the tree no longer shares nodes with Persistent snapshots taken before the flush.
+         * Writes become visible in the tree when the buffer is flushed, which happens when it is full, when flush()
+         * is called, and when the WriteBuffer is destroyed. Until then reads of the tree, including the aggregates of
+         * other mixins, do not see them. contains and at_key on the WriteBuffer see pending writes.
+         * Applying a write can throw, for example when the maximum depth is exceeded with safety checks enabled. The
+         * destructor is noexcept like any other, so an exception from its flush calls std::terminate. Call flush()
+         * before the buffer goes out of scope to handle such errors.
+         */
+        struct WriteBuffer {
+        private:
+            struct Message {
+                Key key;
+                // empty for an erase
+                std::optional<KeyValue> value;
+            };
+
+            // the tree is rebuilt instead of modified in place once there is a pending write for at least one of
+            // every rebuild_ratio values of the tree
+            static constexpr size_t rebuild_ratio = 8;
+
+            Transient& tree;
+            size_t capacity;
+            // runs of messages in the order they were written. each run is sorted by key, with messages that have
+            // equal keys in the order they were written. like the trees of a binomial heap, the run sizes are
+            // decreasing powers of two, so a write moves amortized O(log capacity) messages and a lookup binary
+            // searches O(log capacity) runs
+            std::vector<Message> messages{};
+            std::vector<size_t> run_ends{};
+            std::vector<Message> scratch{};
+
+            [[nodiscard]] size_t run_begin(size_t run) const {
+                return run == 0 ? 0 : run_ends[run - 1];
+            }
+
+            // merges the last run into the one before it
+            void merge_last_runs() {
+                size_t end = run_ends.back();
+                run_ends.pop_back();
+                size_t middle = run_ends.back();
+                size_t out = run_begin(run_ends.size() - 1);
+                run_ends.back() = end;
+                scratch.assign(std::make_move_iterator(messages.begin() + static_cast<ssize>(out)),
+                        std::make_move_iterator(messages.begin() + static_cast<ssize>(middle)));
+                // once scratch is used up the rest of the last run is already in place
+                for (size_t i = 0; i < scratch.size(); ++out) {
+                    if (middle < end && less_than(messages[middle].key, scratch[i].key)) {
+                        messages[out] = std::move(messages[middle++]);
+                    } else {
+                        messages[out] = std::move(scratch[i++]);
+                    }
+                }
+                scratch.clear();
+            }
+
+            void push(Message&& message) {
+                messages.push_back(std::move(message));
+                run_ends.push_back(messages.size());
+                while (run_ends.size() > 1) {
+                    size_t last = run_ends.size() - 1;
+                    if (run_ends[last] - run_begin(last) < run_ends[last - 1] - run_begin(last - 1)) {
+                        break;
+                    }
+                    merge_last_runs();
+                }
+                if (messages.size() >= capacity) {
+                    flush();
+                }
+            }
+
+            [[nodiscard]] Message const* find_pending(Key const& key) const {
+                for (size_t run = run_ends.size(); run-- > 0;) {
+                    auto begin = messages.begin() + static_cast<ssize>(run_begin(run));
+                    auto it = std::upper_bound(begin, messages.begin() + static_cast<ssize>(run_ends[run]), key,
+                            [](Key const& k, Message const& m) { return less_than(k, m.key); });
+                    if (it != begin && !less_than(std::prev(it)->key, key)) {
+                        return &*std::prev(it);
+                    }
+                }
+                return nullptr;
+            }
+
+            // calls f with the last write to each key, in key order. messages must be a single run
+            template <typename F>
+            void for_each_write(F&& f) {
+                for (size_t i = 0; i < messages.size(); ++i) {
+                    if (i + 1 < messages.size() && !less_than(messages[i].key, messages[i + 1].key)) {
+                        // overwritten by a later write to the same key
+                        continue;
+                    }
+                    f(messages[i]);
+                }
+            }
+
+            // merges the pending writes with the values of the tree into a new tree in one pass
+            void rebuild() {
+                auto& self = tree.self();
+                self.assign_parts(1, [this, &self](size_t, auto const& emit) {
+                    auto it = self.cbegin();
+                    auto end = self.cend();
+                    for_each_write([&it, &end, &emit](Message& message) {
+                        for (; it != end && less_than(extractor.get_key(*it), message.key); ++it) {
+                            emit(*it);
+                        }
+                        if (it != end && !less_than(message.key, extractor.get_key(*it))) {
+                            ++it;
+                        }
+                        if (message.value.has_value()) {
+                            emit(std::move(*message.value));
+                        }
+                    });
+                    for (; it != end; ++it) {
+                        emit(*it);
+                    }
+                }, [](size_t count, auto const& body) { body(0, count); });
+            }
+
+            void apply_each() {
+                for_each_write([this](Message& message) {
+                    if (message.value.has_value()) {
+                        tree.insert_or_assign(std::move(*message.value));
+                    } else if (tree.contains(message.key)) {
+                        tree.erase_key(message.key);
+                    }
+                });
+            }
+        public:
+            WriteBuffer(Transient& tree, size_t capacity) : tree(tree), capacity(capacity) {
+                messages.reserve(capacity);
+            }
+
+            WriteBuffer(WriteBuffer const& other) = delete;
+            WriteBuffer& operator=(WriteBuffer const& other) = delete;
+
+            // see the class comment for exceptions thrown while flushing
+            ~WriteBuffer() {
+                flush();
+            }
+
+            /**
+             * Buffers an insert of a new element or an assignment to an existing element with the same key
+             */
+            template <typename... Args>
+            void insert_or_assign(Args&&... args) {
+                Key key(extractor.get_key(std::as_const(args)...));
+                push(Message{std::move(key), std::optional<KeyValue>(std::in_place, std::forward<Args>(args)...)});
+            }
+
+            /**
+             * Buffers an erase of the element with key 'key'. Unlike Transient::erase_key it is not an error if there
+             * is no such element
+             */
+            void erase_key(Key const& key) {
+                push(Message{key, std::nullopt});
+            }
+
+            /**
+             * Applies all pending writes to the tree
+             */
+            void flush() {
+                if (messages.empty()) {
+                    return;
+                }
+                while (run_ends.size() > 1) {
+                    merge_last_runs();
+                }
+                if (messages.size() * rebuild_ratio >= tree.size()) {
+                    rebuild();
+                } else {
+                    apply_each();
+                }
+                messages.clear();
+                run_ends.clear();
+            }
+
+            /**
+             * @return the number of writes that have not been applied to the tree yet
+             */
+            [[nodiscard]] size_t pending() const {
+                return messages.size();
+            }
+
+            /**
+             * @return true if the tree contains an element with key 'key' once pending writes are applied
+             */
+            [[nodiscard]] bool contains(Key const& key) const {
+                Message const* message = find_pending(key);
+                return message != nullptr ? message->value.has_value() : tree.contains(key);
+            }
+
+            /**
+             * @return the value of the element with key 'key' once pending writes are applied. a reference to a
+             * pending value is only valid until the next write to or flush of the buffer
+             */
+            [[nodiscard]] GetValue at_key(Key const& key) {
+                Message const* message = find_pending(key);
+                if (message != nullptr && message->value.has_value()) {
+                    return extractor.get_value(*message->value);
+                }
+                if (message != nullptr) {
+                    // lets the tree report the missing key the same way it would without the buffer
+                    flush();
+                }
+                return tree.at_key(key);
+            }
+        };
+
+        /**
+         * @return a WriteBuffer which applies writes to this tree in sorted batches of 'capacity' writes
+         */
+        [[nodiscard]] WriteBuffer write_buffer(size_t capacity = 1024) {
+            return WriteBuffer(*this, capacity);
+        }
     };
 
     template <typename Parent>
@@ -405,6 +686,9 @@ struct OrderedBuilder {
     template <bool b>
     using binary_search = OrderedBuilder<Extractor, Compare, std::conditional_t<b, std::true_type, std::false_type>>;
 
+    template <SearchMode mode>
+    using search_mode = OrderedBuilder<Extractor, Compare, SearchPolicy<mode>>;
+
     template <typename KeyValue>
     using build = Ordered<KeyValue, Extractor, Compare, BinarySearch>;
 };
@@ -417,26 +701,30 @@ template <
         int leaf_node_bytes_v = 512,
         int internal_node_bytes_v = 512,
         int depth_limit_v = 16,
-        bool disable_exceptions_v = default_disable_exceptions>
+        bool disable_exceptions_v = default_disable_exceptions,
+        SearchMode search_mode_v = binary_search_v ? SearchMode::binary : SearchMode::linear>
 struct BppTreeMap {
 
     template <typename T>
-    using compare = BppTreeMap<Key, Value, T, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v>;
+    using compare = BppTreeMap<Key, Value, T, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v, disable_exceptions_v, search_mode_v>;
 
     template <bool b>
-    using binary_search = BppTreeMap<Key, Value, Compare, b, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v>;
+    using binary_search = BppTreeMap<Key, Value, Compare, b, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v, disable_exceptions_v>;
+
+    template <SearchMode m>
+    using search_mode = BppTreeMap<Key, Value, Compare, m == SearchMode::binary, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v, disable_exceptions_v, m>;
 
     template <int l>
-    using leaf_node_bytes = BppTreeMap<Key, Value, Compare, binary_search_v, l, internal_node_bytes_v, depth_limit_v>;
+    using leaf_node_bytes = BppTreeMap<Key, Value, Compare, binary_search_v, l, internal_node_bytes_v, depth_limit_v, disable_exceptions_v, search_mode_v>;
 
     template <int i>
-    using internal_node_bytes = BppTreeMap<Key, Value, Compare, binary_search_v, leaf_node_bytes_v, i, depth_limit_v>;
+    using internal_node_bytes = BppTreeMap<Key, Value, Compare, binary_search_v, leaf_node_bytes_v, i, depth_limit_v, disable_exceptions_v, search_mode_v>;
 
     template <int d>
-    using depth_limit = BppTreeMap<Key, Value, Compare, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, d>;
+    using depth_limit = BppTreeMap<Key, Value, Compare, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, d, disable_exceptions_v, search_mode_v>;
 
     template <bool b>
-    using disable_exceptions = BppTreeMap<Key, Value, Compare, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v, b>;
+    using disable_exceptions = BppTreeMap<Key, Value, Compare, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v, b, search_mode_v>;
 
     template <typename... Args>
     using mixins = typename BppTree<
@@ -448,7 +736,7 @@ struct BppTreeMap {
         ::template mixins<
                 typename OrderedBuilder<>
                     ::compare<Compare>
-                    ::template binary_search<binary_search_v>,
+                    ::template search_mode<search_mode_v>,
                 Args...>;
 
     using Transient = typename mixins<>::Transient;
@@ -463,26 +751,30 @@ template <
         int leaf_node_bytes_v = 512,
         int internal_node_bytes_v = 512,
         int depth_limit_v = 16,
-        bool disable_exceptions_v = default_disable_exceptions>
+        bool disable_exceptions_v = default_disable_exceptions,
+        SearchMode search_mode_v = binary_search_v ? SearchMode::binary : SearchMode::linear>
 struct BppTreeSet {
 
     template <typename T>
-    using compare = BppTreeSet<Key, T, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v>;
+    using compare = BppTreeSet<Key, T, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v, disable_exceptions_v, search_mode_v>;
 
     template <bool b>
-    using binary_search = BppTreeSet<Key, Compare, b, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v>;
+    using binary_search = BppTreeSet<Key, Compare, b, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v, disable_exceptions_v>;
+
+    template <SearchMode m>
+    using search_mode = BppTreeSet<Key, Compare, m == SearchMode::binary, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v, disable_exceptions_v, m>;
 
     template <int l>
-    using leaf_node_bytes = BppTreeSet<Key, Compare, binary_search_v, l, internal_node_bytes_v, depth_limit_v>;
+    using leaf_node_bytes = BppTreeSet<Key, Compare, binary_search_v, l, internal_node_bytes_v, depth_limit_v, disable_exceptions_v, search_mode_v>;
 
     template <int i>
-    using internal_node_bytes = BppTreeSet<Key, Compare, binary_search_v, leaf_node_bytes_v, i, depth_limit_v>;
+    using internal_node_bytes = BppTreeSet<Key, Compare, binary_search_v, leaf_node_bytes_v, i, depth_limit_v, disable_exceptions_v, search_mode_v>;
 
     template <int d>
-    using depth_limit = BppTreeSet<Key, Compare, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, d>;
+    using depth_limit = BppTreeSet<Key, Compare, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, d, disable_exceptions_v, search_mode_v>;
 
     template <bool b>
-    using disable_exceptions = BppTreeSet<Key, Compare, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v, b>;
+    using disable_exceptions = BppTreeSet<Key, Compare, binary_search_v, leaf_node_bytes_v, internal_node_bytes_v, depth_limit_v, b, search_mode_v>;
 
     template <typename... Args>
     using mixins = typename BppTree<
@@ -495,7 +787,7 @@ struct BppTreeSet {
             typename OrderedBuilder<>
                 ::extractor<ValueExtractor>
                 ::compare<Compare>
-                ::template binary_search<binary_search_v>,
+                ::template search_mode<search_mode_v>,
             Args...>;
 
     using Transient = typename mixins<>::Transient;
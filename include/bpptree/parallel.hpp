@@ -0,0 +1,416 @@
+//
+// B++ Tree: A B+ Tree library written in C++
+// Copyright (C) 2023 Jeff Plaisance
+//
+// This software is distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://boost.org/LICENSE_1_0.txt
+//
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bpptree/detail/helpers.hpp"
+#include "bpptree/detail/parallel_sort.hpp"
+#include "bpptree/detail/thread_pool.hpp"
+
+namespace bpptree {
+namespace detail {
+
+/**
+ * Parallel mixin adds methods that scan a B++ tree on many threads. The tree is cut into chunks with split_range,
+ * several per thread, and each chunk is scanned with for_each. The chunks are run on a ThreadPool, or on any
+ * executor passed as the last argument, which must be callable with a std::function<void()> and may have a size()
+ * method that returns its number of threads.
+ * The tree must not be modified while a parallel method runs. Persistent trees can be shared with other threads
+ * doing the same, Transient trees must not be.
+ * Transient trees that also have the Ordered mixin get build_parallel, merge, and merge_with, which build the tree
+ * from unsorted values or from other trees on many threads.
+ * @tparam Value the value type of the B++ tree
+ */
+template <typename Value>
+struct Parallel {
+    static constexpr size_t sizeof_hint() {
+        return 0;
+    }
+
+    template <typename Parent>
+    struct LeafNode : public Parent {};
+
+    template <typename Parent, auto internal_size>
+    struct InternalNode : public Parent {};
+
+    template <typename Parent>
+    struct NodeInfo : public Parent {
+        NodeInfo() = default;
+
+        template <typename P>
+        NodeInfo(P const& p, const bool changed) : Parent(p, changed) {}
+    };
+
+    template <typename Parent>
+    struct Shared : public Parent {
+        template <typename... Us>
+        explicit Shared(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+
+    private:
+        template <typename Executor>
+        [[nodiscard]] auto chunks(Executor const& executor) const {
+            auto const& tree = this->self();
+            return tree.split_range(tree.cbegin(), tree.cend(), parallel_threads(executor) * parallel_chunks_per_thread);
+        }
+
+    public:
+        /**
+         * Calls f with each value of the tree, from many threads at once and in no particular order
+         */
+        template <typename F, typename Executor = ThreadPool&>
+        void parallel_for_each(F const& f, Executor&& executor = ThreadPool::instance()) const {
+            auto ranges = chunks(executor);
+            parallel_chunks(executor, ranges.size(), [this, &ranges, &f](size_t i) {
+                this->self().for_each(ranges[i].begin(), ranges[i].end(), f);
+            });
+        }
+
+        /**
+         * Like std::transform_reduce, combines transform(value) for each value of the tree and init with reduce,
+         * which must be associative. The values are combined in order, so reduce does not have to be commutative.
+         */
+        template <typename T, typename Reduce, typename Transform, typename Executor = ThreadPool&>
+        [[nodiscard]] T parallel_transform_reduce(
+                T init,
+                Reduce const& reduce,
+                Transform const& transform,
+                Executor&& executor = ThreadPool::instance()) const {
+            auto ranges = chunks(executor);
+            std::vector<std::optional<T>> partials(ranges.size());
+            parallel_chunks(executor, ranges.size(), [this, &ranges, &partials, &reduce, &transform](size_t i) {
+                std::optional<T> partial{};
+                this->self().for_each(ranges[i].begin(), ranges[i].end(), [&partial, &reduce, &transform](Value const& v) {
+                    if (partial) {
+                        partial = reduce(std::move(*partial), transform(v));
+                    } else {
+                        partial.emplace(transform(v));
+                    }
+                });
+                partials[i] = std::move(partial);
+            });
+            for (auto& partial : partials) {
+                if (partial) {
+                    init = reduce(std::move(init), std::move(*partial));
+                }
+            }
+            return init;
+        }
+
+        /**
+         * Like std::reduce, combines the values of the tree and init with reduce, which must be associative
+         */
+        template <typename T, typename Reduce, typename Executor = ThreadPool&>
+        [[nodiscard]] T parallel_reduce(T init, Reduce const& reduce, Executor&& executor = ThreadPool::instance()) const {
+            return parallel_transform_reduce(
+                    std::move(init),
+                    reduce,
+                    [](Value const& v) -> Value const& { return v; },
+                    std::forward<Executor>(executor));
+        }
+    };
+
+    template <typename Parent>
+    struct Transient : public Parent {
+        template <typename... Us>
+        explicit Transient(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+
+    private:
+        // the comparator and key extractor of the Ordered mixin, which the methods of this Transient require
+        template <typename A, typename B>
+        static bool less_than(A const& a, B const& b) {
+            return typename Parent::key_compare()(a, b);
+        }
+
+        static decltype(auto) get_key(Value const& value) {
+            return typename Parent::key_extractor().get_key(value);
+        }
+
+        static bool less_than_by_key(Value const& a, Value const& b) {
+            return less_than(get_key(a), get_key(b));
+        }
+
+        // calls emit with the values of each part of sorted values that duplicate_policy keeps, moving them out.
+        // the parts are filled in parallel by assign_parts, so whether the value at the edge of each part that
+        // depends on the neighboring part is kept is decided first, before any part moves its values
+        template <DuplicatePolicy duplicate_policy, typename Executor>
+        void assign_unique(ParallelBuffer<Value>& values, Executor& executor) {
+            size_t parts = values.part_count();
+            // whether the last value of each part is kept for replace, or the first for ignore
+            std::vector<char> boundary(parts);
+            parallel_chunks(executor, parts, [&values, &boundary, parts](size_t part) {
+                if (values.begin(part) == values.end(part)) {
+                    return;
+                }
+                if constexpr (duplicate_policy == DuplicatePolicy::replace) {
+                    Value const* last = values.end(part) - 1;
+                    boundary[part] = part + 1 == parts || less_than_by_key(*last, *(last + 1));
+                } else {
+                    Value const* first = values.begin(part);
+                    boundary[part] = part == 0 || less_than_by_key(*(first - 1), *first);
+                }
+            });
+            this->self().assign_parts(parts, [&values, &boundary](size_t part, auto&& emit) {
+                Value* begin = values.begin(part);
+                Value* end = values.end(part);
+                // for ignore, whether the value at it is kept, which is decided before the value before it is moved
+                bool keep_next = boundary[part];
+                for (Value* it = begin; it != end; ++it) {
+                    bool keep;
+                    if constexpr (duplicate_policy == DuplicatePolicy::replace) {
+                        // keeps the last of each run of equal keys
+                        keep = it + 1 == end ? boundary[part] : less_than_by_key(*it, *(it + 1));
+                    } else {
+                        // keeps the first of each run of equal keys
+                        keep = keep_next;
+                        keep_next = it + 1 != end && less_than_by_key(*it, *(it + 1));
+                    }
+                    if (keep) {
+                        emit(std::move(*it));
+                    }
+                }
+            }, [&executor](size_t count, auto const& body) { parallel_ranges(executor, count, body); });
+        }
+
+    public:
+        /**
+         * Replaces the contents of this tree with the values in [first, last), which do not have to be sorted. The
+         * values are copied and sorted in parallel, and then the leaves and each level of internal nodes are built
+         * in parallel, computing the state of every mixin for each subtree as the subtrees are linked together.
+         * With DuplicatePolicy::replace the last of the values with the same key is kept, as if each was passed to
+         * insert_or_assign in order, with DuplicatePolicy::ignore the first is kept, as with insert_v, and
+         * DuplicatePolicy::insert keeps all of them. The values that are dropped are skipped while the leaves are
+         * filled, so they are never compacted. Much faster than inserting the values one at a time even on one
+         * thread, because the tree is built bottom up in O(N) after sorting. The threads come from executor, as for
+         * the scans of this mixin.
+         */
+        template <DuplicatePolicy duplicate_policy = DuplicatePolicy::replace, typename It, typename Executor = ThreadPool&>
+        void build_parallel(It first, It last, Executor&& executor = ThreadPool::instance()) {
+            using Category = typename std::iterator_traits<It>::iterator_category;
+            if constexpr (!std::is_base_of_v<std::random_access_iterator_tag, Category>) {
+                // the values can only be copied in parallel from random access iterators
+                std::vector<Value> values(first, last);
+                build_parallel<duplicate_policy>(
+                        std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()), executor);
+            } else {
+                auto count = static_cast<size_t>(last - first);
+                if (count == 0) {
+                    this->self().clear();
+                    return;
+                }
+                using Diff = typename std::iterator_traits<It>::difference_type;
+                size_t parts = std::min(count, parallel_threads(executor) * parallel_chunks_per_thread);
+                ParallelBuffer<Value> values(count, parts);
+                values.construct(executor, [first](size_t begin, size_t end, Value* out) {
+                    std::uninitialized_copy(first + static_cast<Diff>(begin), first + static_cast<Diff>(end), out);
+                });
+                parallel_stable_sort(values.begin(), values.end(), less_than_by_key, executor);
+                if constexpr (duplicate_policy == DuplicatePolicy::insert) {
+                    this->self().assign_sorted(
+                            std::make_move_iterator(values.begin()),
+                            std::make_move_iterator(values.end()),
+                            [&executor](size_t count, auto const& body) { parallel_ranges(executor, count, body); });
+                } else {
+                    assign_unique<duplicate_policy>(values, executor);
+                }
+                values.destroy(executor);
+            }
+        }
+
+    private:
+        template <typename Tree>
+        static auto snapshot(Tree const& tree) {
+            if constexpr (IsTransientTree<Tree>::value) {
+                return tree.persistent();
+            } else {
+                return tree;
+            }
+        }
+
+        // calls emit with the values of ranges, which are [begin, end) pairs of iterators into sorted trees, merged
+        // into one sorted sequence. values with equal keys are resolved by duplicate_policy in the order of ranges.
+        template <DuplicatePolicy duplicate_policy, typename Range, typename F>
+        static void merge_ranges(std::vector<Range>& ranges, F&& emit) {
+            auto key = [](Range const& range) -> decltype(auto) { return get_key(*range.first); };
+            // min heap ordered by the key of the next value of each range and then by the position of the range
+            std::vector<size_t> heap{};
+            auto greater = [&ranges, &key](size_t a, size_t b) {
+                return less_than(key(ranges[b]), key(ranges[a])) || (!less_than(key(ranges[a]), key(ranges[b])) && b < a);
+            };
+            for (size_t i = 0; i < ranges.size(); ++i) {
+                if (ranges[i].first != ranges[i].second) {
+                    heap.push_back(i);
+                }
+            }
+            std::make_heap(heap.begin(), heap.end(), greater);
+            std::vector<size_t> equal{};
+            while (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), greater);
+                equal.assign(1, heap.back());
+                heap.pop_back();
+                if constexpr (duplicate_policy != DuplicatePolicy::insert) {
+                    // ties are popped in the order of ranges
+                    while (!heap.empty() && !less_than(key(ranges[equal.front()]), key(ranges[heap.front()]))) {
+                        std::pop_heap(heap.begin(), heap.end(), greater);
+                        equal.push_back(heap.back());
+                        heap.pop_back();
+                    }
+                }
+                size_t emitted = duplicate_policy == DuplicatePolicy::replace ? equal.back() : equal.front();
+                auto chosen = ranges[emitted].first;
+                if constexpr (duplicate_policy == DuplicatePolicy::insert) {
+                    ++ranges[emitted].first;
+                } else {
+                    // skips every value with this key, including repeats within one range
+                    for (size_t index : equal) {
+                        auto& range = ranges[index];
+                        while (range.first != range.second && !less_than(get_key(*chosen), key(range))) {
+                            if (duplicate_policy == DuplicatePolicy::replace && index == emitted) {
+                                chosen = range.first;
+                            }
+                            ++range.first;
+                        }
+                    }
+                }
+                emit(*chosen);
+                for (size_t index : equal) {
+                    if (ranges[index].first != ranges[index].second) {
+                        heap.push_back(index);
+                        std::push_heap(heap.begin(), heap.end(), greater);
+                    }
+                }
+            }
+        }
+
+        // replaces the contents of this tree with the merged values of the sources at the indexes in run, which are
+        // in the order that duplicates are resolved in, cutting the key space into parts at keys taken from the
+        // largest of them
+        template <DuplicatePolicy duplicate_policy, typename Executor, typename Snapshot>
+        void merge_run(Executor&& executor, std::vector<Snapshot> const& sources, std::vector<size_t> const& run, size_t parts) {
+            Snapshot const* largest = &sources[run[0]];
+            for (size_t index : run) {
+                if (sources[index].size() > largest->size()) {
+                    largest = &sources[index];
+                }
+            }
+            using Key = std::remove_cv_t<std::remove_reference_t<decltype(get_key(std::declval<Value const&>()))>>;
+            std::vector<Key> splitters{};
+            auto cuts = largest->split_range(largest->begin(), largest->end(), parts);
+            for (size_t i = 1; i < cuts.size(); ++i) {
+                if (cuts[i].begin() != largest->end()) {
+                    splitters.push_back(get_key(*cuts[i].begin()));
+                }
+            }
+            using It = typename Snapshot::const_iterator;
+            this->self().assign_parts(
+                    splitters.size() + 1,
+                    [&sources, &run, &splitters](size_t part, auto&& emit) {
+                        std::vector<std::pair<It, It>> ranges{};
+                        for (size_t index : run) {
+                            auto const& source = sources[index];
+                            ranges.emplace_back(
+                                    part == 0 ? source.begin() : source.lower_bound(splitters[part - 1]),
+                                    part == splitters.size() ? source.end() : source.lower_bound(splitters[part]));
+                        }
+                        merge_ranges<duplicate_policy>(ranges, emit);
+                    },
+                    [&executor](size_t count, auto const& body) { parallel_ranges(executor, count, body); });
+        }
+
+    public:
+        /**
+         * Replaces the contents of this tree with the values of this tree and trees merged together. Each of trees may
+         * be a Transient or a Persistent tree of this type. Values with the same key are resolved by duplicate_policy
+         * in the order this tree, trees..., so with DuplicatePolicy::replace the value from the last tree is kept.
+         * Once sorted by their smallest key, the trees fall into runs whose key ranges overlap. A run of one tree is
+         * joined in whole with assign_concatenated without copying any value, so its nodes become shared with the
+         * tree as if it was a snapshot of it. Each run of several trees is merged on its own first: its key space is
+         * cut into parts at keys taken from its largest tree, and the parts are merged in parallel on executor, each
+         * one straight into packed leaves.
+         */
+        template <DuplicatePolicy duplicate_policy = DuplicatePolicy::replace, typename Executor, typename... Trees>
+        void merge_with(Executor&& executor, Trees const&... trees) {
+            using Snapshot = decltype(snapshot(this->self()));
+            std::vector<Snapshot> sources{snapshot(this->self()), snapshot(trees)...};
+            std::vector<size_t> nonempty{};
+            size_t total_size = 0;
+            for (size_t i = 0; i < sources.size(); ++i) {
+                if (!sources[i].empty()) {
+                    nonempty.push_back(i);
+                    total_size += sources[i].size();
+                }
+            }
+            std::stable_sort(nonempty.begin(), nonempty.end(), [&sources](size_t a, size_t b) {
+                return less_than(get_key(sources[a].front()), get_key(sources[b].front()));
+            });
+            size_t parts = parallel_threads(executor) * parallel_chunks_per_thread;
+            std::vector<Snapshot> pieces{};
+            for (size_t first = 0; first < nonempty.size();) {
+                // a run ends at the first tree that starts after every tree before it in the run ends
+                size_t last = first + 1;
+                Snapshot const* run_back = &sources[nonempty[first]];
+                for (; last < nonempty.size(); ++last) {
+                    Snapshot const& next = sources[nonempty[last]];
+                    if (less_than(get_key(run_back->back()), get_key(next.front()))) {
+                        break;
+                    }
+                    if (less_than(get_key(run_back->back()), get_key(next.back()))) {
+                        run_back = &next;
+                    }
+                }
+                if (last == first + 1) {
+                    pieces.push_back(sources[nonempty[first]]);
+                } else {
+                    // duplicates are resolved in the order of the trees in the arguments, not in the order of keys
+                    std::vector<size_t> run(nonempty.begin() + static_cast<ssize>(first), nonempty.begin() + static_cast<ssize>(last));
+                    std::sort(run.begin(), run.end());
+                    size_t run_size = 0;
+                    for (size_t index : run) {
+                        run_size += sources[index].size();
+                    }
+                    std::decay_t<decltype(this->self())> merged{};
+                    merged.template merge_run<duplicate_policy>(
+                            executor, sources, run, std::max(size_t(1), parts * run_size / total_size));
+                    pieces.push_back(merged.persistent());
+                }
+                first = last;
+            }
+            this->self().assign_concatenated(pieces);
+        }
+
+        /**
+         * Same as merge_with, on the default ThreadPool
+         */
+        template <DuplicatePolicy duplicate_policy = DuplicatePolicy::replace, typename... Trees>
+        void merge(Trees const&... trees) {
+            merge_with<duplicate_policy>(ThreadPool::instance(), trees...);
+        }
+    };
+
+    template <typename Parent>
+    struct Persistent : public Parent {
+        template <typename... Us>
+        explicit Persistent(Us&&... us) : Parent(std::forward<Us>(us)...) {}
+    };
+};
+
+struct ParallelBuilder {
+    template <typename Value>
+    using build = Parallel<Value>;
+};
+} //end namespace detail
+using detail::Parallel;
+using detail::ParallelBuilder;
+using detail::ThreadPool;
+} //end namespace bpptree
@@ -0,0 +1,545 @@
+//
+// B++ Tree: A B+ Tree library written in C++
+// Copyright (C) 2023 Jeff Plaisance
+//
+// This software is distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://boost.org/LICENSE_1_0.txt
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+#include "bpptree/detail/helpers.hpp"
+
+namespace bpptree {
+namespace detail {
+
+/**
+ * RadixPartitioned splits an ordered tree keyed by an integer into 2^radix_bits independent subtrees of type Tree,
+ * selected directly by the top radix_bits bits of the key. Each lookup or modification skips the levels of a single
+ * large tree that would otherwise route on those bits, and modifications to different partitions touch disjoint nodes.
+ * Iteration visits the partitions in order so it is globally ordered by key. Aggregates (size, sum, min, max, order,
+ * at_index) combine the partitions and are available when the partition tree has the corresponding mixin.
+ * Signed keys have their sign bit flipped before partitioning so that partition order matches key order. The
+ * partition tree must order keys with MinComparator (ascending).
+ * Partitions are kept in reference counted chunks of about sqrt(2^radix_bits) partitions each and are only created
+ * once a key is inserted into them. A modification of a Persistent copies the chunk pointers and the one chunk it
+ * touches, so it costs O(sqrt(2^radix_bits)) reference count updates instead of O(2^radix_bits).
+ * @tparam Key integral key type of the partition tree
+ * @tparam Tree a B++ tree type with Ordered, for example BppTreeMap<int64_t, int64_t>::mixins<...>
+ * @tparam radix_bits number of high order key bits used to select a partition
+ */
+template <typename Key, typename Tree, int radix_bits = 8>
+struct RadixPartitioned {
+    static_assert(std::is_integral_v<Key>, "RadixPartitioned requires an integral key");
+    static_assert(radix_bits > 0 && radix_bits <= 16 && radix_bits <= std::numeric_limits<std::make_unsigned_t<Key>>::digits,
+                  "radix_bits must be between 1 and min(16, bits in Key)");
+    static_assert(std::is_same_v<typename Tree::Transient::key_compare, MinComparator>,
+                  "RadixPartitioned requires a partition tree ordered by MinComparator");
+
+    static constexpr size_t partitions_count = size_t{1} << radix_bits;
+
+    /**
+     * @return the index of the partition containing key
+     */
+    static constexpr size_t partition_of(Key const& key) {
+        using Unsigned = std::make_unsigned_t<Key>;
+        constexpr int digits = std::numeric_limits<Unsigned>::digits;
+        auto u = static_cast<Unsigned>(key);
+        if constexpr (std::is_signed_v<Key>) {
+            u = static_cast<Unsigned>(u ^ (Unsigned{1} << (digits - 1)));
+        }
+        return static_cast<size_t>(u >> (digits - radix_bits));
+    }
+
+private:
+    static constexpr int chunk_bits = radix_bits / 2;
+
+    static constexpr size_t chunk_size = size_t{1} << chunk_bits;
+
+    static constexpr size_t chunks_count = partitions_count >> chunk_bits;
+
+    // a partition that has never had a key inserted into it is an empty optional
+    template <typename Partition>
+    using Chunk = std::array<std::optional<Partition>, chunk_size>;
+
+    template <typename Partition>
+    using Chunks = std::array<std::shared_ptr<Chunk<Partition>>, chunks_count>;
+
+    // converts every partition that exists with f, which is how Transients and Persistents are turned into each other
+    template <typename To, typename From, typename F>
+    static Chunks<To> convert(Chunks<From>& chunks, F const& f) {
+        Chunks<To> ret{};
+        for (size_t c = 0; c < chunks_count; ++c) {
+            if (chunks[c] != nullptr) {
+                ret[c] = std::make_shared<Chunk<To>>();
+                for (size_t i = 0; i < chunk_size; ++i) {
+                    if ((*chunks[c])[i]) {
+                        (*ret[c])[i].emplace(f(*(*chunks[c])[i]));
+                    }
+                }
+            }
+        }
+        return ret;
+    }
+
+public:
+    template <typename Derived, typename Partition>
+    struct Shared {
+    protected:
+        static constexpr size_t no_partition = partitions_count;
+
+        Chunks<Partition> chunks{};
+
+        // the number of elements in every partition except checked_out, which a Transient has handed out to be
+        // modified and which is only counted when size() is called
+        size_t counted_size = 0;
+
+        size_t checked_out = no_partition;
+
+        Shared() = default;
+
+        Shared(Chunks<Partition>&& chunks, size_t size) : chunks(std::move(chunks)), counted_size(size) {}
+
+        // stands in for every partition that does not exist yet
+        static Partition const& empty_partition() {
+            static Partition const empty{};
+            return empty;
+        }
+
+        template <typename F>
+        void for_each_partition(F const& f) const {
+            for (auto const& chunk : chunks) {
+                if (chunk != nullptr) {
+                    for (auto const& partition : *chunk) {
+                        if (partition) {
+                            f(*partition);
+                        }
+                    }
+                }
+            }
+        }
+
+    public:
+        /**
+         * Bidirectional iterator over the elements of all partitions in key order
+         */
+        class const_iterator {
+            friend struct Shared;
+
+            using PartitionIterator = typename Partition::const_iterator;
+
+            Shared const* tree = nullptr;
+            size_t partition = 0;
+            PartitionIterator it;
+
+            const_iterator(Shared const& tree, size_t partition, PartitionIterator const& it) :
+                    tree(&tree), partition(partition), it(it) {}
+
+            // moves forward past the end of empty partitions, stopping at the end of the last partition
+            void skip_empty() {
+                while (partition + 1 < partitions_count && it == tree->partition_tree(partition).cend()) {
+                    ++partition;
+                    it = tree->partition_tree(partition).cbegin();
+                }
+            }
+
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = typename std::iterator_traits<PartitionIterator>::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = typename std::iterator_traits<PartitionIterator>::pointer;
+            using reference = decltype(*std::declval<PartitionIterator const&>());
+
+            [[nodiscard]] reference operator*() const {
+                return *it;
+            }
+
+            [[nodiscard]] auto operator->() const {
+                return it.operator->();
+            }
+
+            const_iterator& operator++() {
+                ++it;
+                skip_empty();
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator ret = *this;
+                ++*this;
+                return ret;
+            }
+
+            const_iterator& operator--() {
+                while (it == tree->partition_tree(partition).cbegin()) {
+                    --partition;
+                    it = tree->partition_tree(partition).cend();
+                }
+                --it;
+                return *this;
+            }
+
+            const_iterator operator--(int) {
+                const_iterator ret = *this;
+                --*this;
+                return ret;
+            }
+
+            [[nodiscard]] bool operator==(const_iterator const& other) const {
+                return partition == other.partition && it == other.it;
+            }
+
+            [[nodiscard]] bool operator!=(const_iterator const& other) const {
+                return !(*this == other);
+            }
+
+            /**
+             * @return the index of the partition this iterator points into
+             */
+            [[nodiscard]] size_t partition_index() const {
+                return partition;
+            }
+
+            /**
+             * @return the iterator into the partition tree
+             */
+            [[nodiscard]] PartitionIterator const& partition_iterator() const {
+                return it;
+            }
+        };
+
+    private:
+        // converts an iterator into partition p into a global iterator, moving past the end of p if necessary
+        [[nodiscard]] const_iterator make_iterator(size_t p, typename Partition::const_iterator const& it) const {
+            const_iterator ret(*this, p, it);
+            ret.skip_empty();
+            return ret;
+        }
+
+    public:
+        /**
+         * @return partition tree p, which is an empty tree if no key has been inserted into it yet
+         */
+        [[nodiscard]] Partition const& partition_tree(size_t p) const {
+            auto const& chunk = chunks[p >> chunk_bits];
+            if (chunk != nullptr) {
+                auto const& partition = (*chunk)[p & (chunk_size - 1)];
+                if (partition) {
+                    return *partition;
+                }
+            }
+            return empty_partition();
+        }
+
+        [[nodiscard]] size_t size() const {
+            return checked_out == no_partition ? counted_size : counted_size + partition_tree(checked_out).size();
+        }
+
+        [[nodiscard]] bool empty() const {
+            return size() == 0;
+        }
+
+        [[nodiscard]] const_iterator begin() const {
+            return make_iterator(0, partition_tree(0).cbegin());
+        }
+
+        [[nodiscard]] const_iterator end() const {
+            return const_iterator(*this, partitions_count - 1, partition_tree(partitions_count - 1).cend());
+        }
+
+        [[nodiscard]] const_iterator cbegin() const {
+            return begin();
+        }
+
+        [[nodiscard]] const_iterator cend() const {
+            return end();
+        }
+
+        [[nodiscard]] decltype(auto) at_key(Key const& key) const {
+            return partition_tree(partition_of(key)).at_key(key);
+        }
+
+        [[nodiscard]] decltype(auto) operator[](Key const& key) const {
+            return at_key(key);
+        }
+
+        [[nodiscard]] bool contains(Key const& key) const {
+            return partition_tree(partition_of(key)).contains(key);
+        }
+
+        /**
+         * @return an iterator pointing to the element with key 'key', or end() if there is no such element
+         */
+        [[nodiscard]] const_iterator find(Key const& key) const {
+            size_t p = partition_of(key);
+            auto const& partition = partition_tree(p);
+            auto it = partition.find(key);
+            return it == partition.cend() ? end() : const_iterator(*this, p, it);
+        }
+
+        /**
+         * @return an iterator pointing to the first element with a key >= 'key'
+         */
+        [[nodiscard]] const_iterator lower_bound(Key const& key) const {
+            size_t p = partition_of(key);
+            return make_iterator(p, partition_tree(p).lower_bound(key));
+        }
+
+        /**
+         * @return an iterator pointing to the first element with a key > 'key'
+         */
+        [[nodiscard]] const_iterator upper_bound(Key const& key) const {
+            size_t p = partition_of(key);
+            return make_iterator(p, partition_tree(p).upper_bound(key));
+        }
+
+        /**
+         * @return the sum over all partitions, requires Summed
+         */
+        template <typename P = Partition>
+        [[nodiscard]] auto sum() const {
+            decltype(std::declval<P const&>().sum()) ret{};
+            for_each_partition([&ret](P const& partition) { ret += partition.sum(); });
+            return ret;
+        }
+
+    private:
+        template <typename Comp, typename F>
+        [[nodiscard]] decltype(auto) extremum(F const& f) const {
+            Partition const* best = nullptr;
+            for_each_partition([&best, &f](Partition const& partition) {
+                if (!partition.empty() && (best == nullptr || Comp()(f(partition), f(*best)))) {
+                    best = &partition;
+                }
+            });
+#ifdef BPPTREE_SAFETY_CHECKS
+            if (best == nullptr) {
+                throw std::out_of_range("cannot find min or max of empty tree");
+            }
+#endif
+            return f(*best);
+        }
+
+    public:
+        /**
+         * @return the smallest min over all partitions, requires Min with MinComparator
+         */
+        template <typename P = Partition>
+        [[nodiscard]] decltype(auto) min() const {
+            return extremum<MinComparator>([](P const& p) -> decltype(auto) { return p.min(); });
+        }
+
+        /**
+         * @return the largest max over all partitions, requires Max with MaxComparator
+         */
+        template <typename P = Partition>
+        [[nodiscard]] decltype(auto) max() const {
+            return extremum<MaxComparator>([](P const& p) -> decltype(auto) { return p.max(); });
+        }
+
+        /**
+         * @return the index of the element pointed to by it in the whole tree, requires Indexed
+         */
+        [[nodiscard]] size_t order(const_iterator const& it) const {
+            size_t ret = 0;
+            for (size_t p = 0; p < it.partition_index(); ++p) {
+                ret += partition_tree(p).size();
+            }
+            return ret + static_cast<size_t>(partition_tree(it.partition_index()).order(it.partition_iterator()));
+        }
+
+        /**
+         * @return the element at index in the whole tree, requires Indexed
+         */
+        template <typename P = Partition>
+        [[nodiscard]] decltype(auto) at_index(size_t index) const {
+            size_t p = 0;
+            while (p + 1 < partitions_count && index >= partition_tree(p).size()) {
+                index -= partition_tree(p).size();
+                ++p;
+            }
+#ifdef BPPTREE_SAFETY_CHECKS
+            if (index >= partition_tree(p).size()) {
+                throw std::out_of_range("index out of range");
+            }
+#endif
+            return partition_tree(p).at_index(index);
+        }
+    };
+
+    class Persistent;
+
+    class Transient : public Shared<Transient, typename Tree::Transient> {
+        using Parent = Shared<Transient, typename Tree::Transient>;
+
+        friend class Persistent;
+
+        Transient(Chunks<typename Tree::Transient>&& chunks, size_t size) : Parent(std::move(chunks), size) {}
+
+    public:
+        Transient() = default;
+
+        /**
+         * Copies share their chunks until one of them modifies a chunk, which then makes its own copy of it.
+         */
+        Transient(Transient const& other) = default;
+
+        Transient& operator=(Transient const& other) = default;
+
+        Transient(Transient&& other) noexcept = default;
+
+        Transient& operator=(Transient&& other) noexcept = default;
+
+        [[nodiscard]] Persistent persistent() const& {
+            auto chunks = this->chunks;
+            return Persistent(convert<typename Tree::Persistent>(chunks,
+                    [](typename Tree::Transient const& partition) { return partition.persistent(); }), this->size());
+        }
+
+        [[nodiscard]] Persistent persistent() && {
+            size_t size = this->size();
+            return Persistent(convert<typename Tree::Persistent>(this->chunks,
+                    [](typename Tree::Transient& partition) { return std::move(partition).persistent(); }), size);
+        }
+
+        /**
+         * @return the partition tree containing key, which may be modified directly as long as only keys that map
+         * to the same partition are inserted. size() stays correct as long as only the partition returned by the
+         * latest call is modified.
+         */
+        [[nodiscard]] typename Tree::Transient& partition(Key const& key) {
+            size_t p = partition_of(key);
+            if (p != this->checked_out) {
+                this->counted_size = this->size() - this->partition_tree(p).size();
+                this->checked_out = p;
+            }
+            auto& chunk = this->chunks[p >> chunk_bits];
+            if (chunk == nullptr) {
+                chunk = std::make_shared<Chunk<typename Tree::Transient>>();
+            } else if (chunk.use_count() > 1) {
+                // shared with a copy of this tree, so the partitions are copied through a snapshot, which makes the
+                // nodes they share copy on write
+                auto copy = std::make_shared<Chunk<typename Tree::Transient>>();
+                for (size_t i = 0; i < chunk_size; ++i) {
+                    if ((*chunk)[i]) {
+                        (*copy)[i].emplace((*chunk)[i]->persistent().transient());
+                    }
+                }
+                chunk = std::move(copy);
+            }
+            auto& partition = (*chunk)[p & (chunk_size - 1)];
+            if (!partition) {
+                partition.emplace();
+            }
+            return *partition;
+        }
+
+        template <typename... Args>
+        void insert_or_assign(Key const& key, Args&&... args) {
+            partition(key).insert_or_assign(key, std::forward<Args>(args)...);
+        }
+
+        template <typename... Args>
+        void insert_v(Key const& key, Args&&... args) {
+            partition(key).insert_v(key, std::forward<Args>(args)...);
+        }
+
+        void erase_key(Key const& key) {
+            // looked up first so that erasing an absent key doesn't create or copy its chunk
+            if (this->contains(key)) {
+                partition(key).erase_key(key);
+            }
+        }
+
+        template <typename U>
+        void update_key(Key const& key, U&& updater) {
+            partition(key).update_key(key, std::forward<U>(updater));
+        }
+
+        void clear() {
+            for (auto& chunk : this->chunks) {
+                chunk = nullptr;
+            }
+            this->counted_size = 0;
+            this->checked_out = Parent::no_partition;
+        }
+    };
+
+    class Persistent : public Shared<Persistent, typename Tree::Persistent> {
+        using Parent = Shared<Persistent, typename Tree::Persistent>;
+
+        friend class Transient;
+
+        Persistent(Chunks<typename Tree::Persistent>&& chunks, size_t size) : Parent(std::move(chunks), size) {}
+
+        // the copy shares every chunk except the one containing key, which is copied with f applied to the partition
+        template <typename F>
+        [[nodiscard]] Persistent modify_partition(Key const& key, F&& f) const {
+            Persistent ret(*this);
+            size_t p = partition_of(key);
+            auto& chunk = ret.chunks[p >> chunk_bits];
+            auto copy = chunk == nullptr
+                    ? std::make_shared<Chunk<typename Tree::Persistent>>()
+                    : std::make_shared<Chunk<typename Tree::Persistent>>(*chunk);
+            auto& partition = (*copy)[p & (chunk_size - 1)].emplace(f(this->partition_tree(p)));
+            ret.counted_size = ret.counted_size - this->partition_tree(p).size() + partition.size();
+            chunk = std::move(copy);
+            return ret;
+        }
+
+    public:
+        Persistent() = default;
+
+        [[nodiscard]] Transient transient() const& {
+            auto chunks = this->chunks;
+            return Transient(convert<typename Tree::Transient>(chunks,
+                    [](typename Tree::Persistent const& partition) { return partition.transient(); }), this->size());
+        }
+
+        [[nodiscard]] Transient transient() && {
+            return Transient(convert<typename Tree::Transient>(this->chunks,
+                    [](typename Tree::Persistent& partition) { return std::move(partition).transient(); }),
+                    this->size());
+        }
+
+        template <typename... Args>
+        [[nodiscard]] Persistent insert_or_assign(Key const& key, Args&&... args) const {
+            return modify_partition(key, [&](auto const& partition) {
+                return partition.insert_or_assign(key, std::forward<Args>(args)...);
+            });
+        }
+
+        template <typename... Args>
+        [[nodiscard]] Persistent insert_v(Key const& key, Args&&... args) const {
+            return modify_partition(key, [&](auto const& partition) {
+                return partition.insert_v(key, std::forward<Args>(args)...);
+            });
+        }
+
+        [[nodiscard]] Persistent erase_key(Key const& key) const {
+            if (!this->contains(key)) {
+                return *this;
+            }
+            return modify_partition(key, [&key](auto const& partition) { return partition.erase_key(key); });
+        }
+
+        template <typename U>
+        [[nodiscard]] Persistent update_key(Key const& key, U&& updater) const {
+            return modify_partition(key, [&](auto const& partition) {
+                return partition.update_key(key, std::forward<U>(updater));
+            });
+        }
+    };
+};
+} //end namespace detail
+using detail::RadixPartitioned;
+} //end namespace bpptree
@@ -1,6 +1,7 @@
 #include <deque>
 #include "gtest/gtest.h"
 #include "test_common.hpp"
+#include "bpptree/offset_leaves.hpp"
 
 TEST(BppTreeTest, TestDeque) {
     static constexpr int n = 10*1000*1000;
@@ -61,3 +62,59 @@ TEST(BppTreeTest, TestPersistentDeque) {
     }
     EXPECT_TRUE(tree.empty());
 }
+
+TEST(BppTreeTest, TestOffsetLeavesDeque) {
+    static constexpr int n = 1000*1000;
+    auto rand_ints = RandInts<int32_t, n>::ints;
+    std::deque<int32_t> deq{};
+    using TreeType = BppTree<int32_t, 512, 512, 6>::mixins<OffsetLeavesBuilder, IndexedBuilder<>>;
+    TreeType::Transient tree{};
+    TreeType::Persistent snapshot{};
+    for (size_t i = 0; i < rand_ints.size(); ++i) {
+        int32_t v = rand_ints[i];
+        switch (v & 7) {
+            case 0:
+            case 1:
+            case 2:
+                deq.emplace_front(v);
+                tree.push_front(v);
+                break;
+            case 3:
+            case 4:
+            case 5:
+                deq.emplace_back(v);
+                tree.push_back(v);
+                break;
+            case 6:
+                if (!deq.empty()) {
+                    EXPECT_EQ(deq.front(), tree.pop_front());
+                    deq.pop_front();
+                }
+                break;
+            default:
+                if (!deq.empty()) {
+                    size_t erase_index = static_cast<size_t>(v >> 3) % deq.size();
+                    deq.erase(deq.begin() + signed_cast(erase_index));
+                    tree.erase_index(erase_index);
+                }
+                size_t index = static_cast<size_t>(v >> 3) % (deq.size() + 1);
+                deq.insert(deq.begin() + signed_cast(index), v);
+                tree.insert_index(index, v);
+        }
+        if (i % 100000 == 0) {
+            snapshot = tree.persistent();
+        }
+    }
+    EXPECT_EQ(deq.size(), tree.size());
+    EXPECT_TRUE(std::equal(deq.cbegin(), deq.cend(), tree.cbegin(), tree.cend()));
+    EXPECT_TRUE(std::equal(deq.crbegin(), deq.crend(), tree.crbegin(), tree.crend()));
+    while (!deq.empty()) {
+        EXPECT_EQ(deq.back(), tree.pop_back());
+        deq.pop_back();
+        if (!deq.empty()) {
+            EXPECT_EQ(deq.front(), tree.pop_front());
+            deq.pop_front();
+        }
+    }
+    EXPECT_TRUE(tree.empty());
+}
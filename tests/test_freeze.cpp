@@ -0,0 +1,58 @@
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_common.hpp"
+#include "bpptree/min.hpp"
+
+using namespace std;
+
+template <typename A, typename B>
+static bool equal_trees(A const& a, B const& b) {
+    return std::equal(a.cbegin(), a.cend(), b.cbegin(), b.cend());
+}
+
+TEST(BppTreeTest, TestFreezeThaw) {
+    static constexpr int n = 100*1000;
+    Vector<int32_t> const& rand_ints = RandInts<int32_t, n>::ints;
+
+    using TreeType = BppTreeMap<int32_t, int32_t>::depth_limit<6>::mixins<
+            SummedBuilder<PairExtractor<1>>,
+            MinBuilder<>::extractor<PairExtractor<1>>>;
+    TreeType::Transient transient{};
+    for (int32_t i : rand_ints) {
+        transient.insert_or_assign(i, i % 1000);
+    }
+    TreeType::Persistent tree = transient.persistent();
+    TreeType::Persistent frozen = tree.freeze();
+    EXPECT_EQ(frozen.size(), tree.size());
+    EXPECT_EQ(frozen.depth(), tree.depth());
+    EXPECT_TRUE(equal_trees(frozen, tree));
+    EXPECT_TRUE(std::equal(frozen.crbegin(), frozen.crend(), tree.crbegin(), tree.crend()));
+    EXPECT_EQ(frozen.sum(), tree.sum());
+    EXPECT_EQ(frozen.min(), tree.min());
+    EXPECT_EQ(frozen.min_element().get(), tree.min_element().get());
+    for (int32_t i = 0; i < n; i += 101) {
+        EXPECT_EQ(frozen.at_key(i), i % 1000);
+        EXPECT_EQ(frozen.sum_inclusive(frozen.find(i)), tree.sum_inclusive(tree.find(i)));
+    }
+
+    // modifying a frozen tree copies the modified nodes out of the frozen memory
+    auto modified = frozen.transient();
+    for (int32_t i = 0; i < n; i += 2) {
+        modified.erase_key(i);
+    }
+    EXPECT_EQ(modified.size(), static_cast<size_t>(n / 2));
+    EXPECT_TRUE(equal_trees(frozen, tree));
+
+    TreeType::Persistent thawed = modified.persistent().freeze().thaw();
+    EXPECT_TRUE(equal_trees(thawed, modified));
+    EXPECT_EQ(thawed.sum(), modified.sum());
+
+    reset_counters();
+    {
+        TreeType::Persistent frozen2 = tree.freeze();
+        EXPECT_EQ(frozen2.sum(), tree.sum());
+        EXPECT_GT(allocations, 0);
+    }
+    EXPECT_EQ(allocations, deallocations);
+    reset_counters();
+}
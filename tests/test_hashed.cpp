@@ -0,0 +1,159 @@
+#include <map>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_common.hpp"
+#include "bpptree/hashed.hpp"
+
+using namespace std;
+
+template <typename Tree>
+static void check_lookups(Tree const& tree, std::map<int32_t, int32_t> const& expected, int32_t max_key, int32_t step) {
+    for (int32_t key = 0; key < max_key; key += step) {
+        auto found = expected.find(key);
+        ASSERT_EQ(tree.contains(key), found != expected.end());
+        auto it = tree.find(key);
+        if (found == expected.end()) {
+            ASSERT_TRUE(it == tree.end());
+        } else {
+            ASSERT_EQ(tree.at_key(key), found->second);
+            ASSERT_EQ(it->first, key);
+            ASSERT_EQ(it->second, found->second);
+            // the iterator must be able to move across leaves
+            ++it;
+            ++found;
+            if (found == expected.end()) {
+                ASSERT_TRUE(it == tree.end());
+            } else {
+                ASSERT_EQ(it->first, found->first);
+            }
+        }
+    }
+}
+
+TEST(BppTreeTest, TestHashedRandomModifications) {
+    static constexpr int n = 20*1000;
+    Vector<int32_t> const& rand_ints = RandInts<int32_t, n>::ints;
+
+    using TreeType = BppTreeMap<int32_t, int32_t>::mixins<HashedBuilder<>>;
+    TreeType::Transient tree{};
+    std::map<int32_t, int32_t> expected{};
+    std::vector<TreeType::Persistent> snapshots{};
+    for (int i = 0; i < n; ++i) {
+        int32_t key = rand_ints[static_cast<size_t>(i)] % (n / 2);
+        int32_t value = i;
+        if (i % 3 == 2 && expected.count(key) > 0) {
+            tree.erase_key(key);
+            expected.erase(key);
+        } else {
+            tree.insert_or_assign(key, value);
+            expected[key] = value;
+        }
+        if (i % 997 == 0) {
+            snapshots.push_back(tree.persistent());
+        }
+        if (i % 101 == 0) {
+            check_lookups(tree, expected, n / 2, 7);
+            check_lookups(std::as_const(tree), expected, n / 2, 11);
+        }
+    }
+    check_lookups(tree, expected, n / 2, 1);
+
+    // modifications after looking up every key must not leave stale entries behind
+    for (auto const& [key, value] : std::map<int32_t, int32_t>(expected)) {
+        if (key % 2 == 0) {
+            tree.erase_key(key);
+            expected.erase(key);
+        } else {
+            tree.assign_v(key, value + 1);
+            expected[key] = value + 1;
+        }
+    }
+    check_lookups(tree, expected, n / 2, 1);
+
+    TreeType::Persistent snapshot = tree.persistent();
+    tree.clear();
+    expected.clear();
+    check_lookups(tree, expected, n / 2, 1);
+    EXPECT_TRUE(snapshot.size() > 0);
+
+    tree = snapshot.transient();
+    for (auto it = snapshot.cbegin(); it != snapshot.cend(); ++it) {
+        expected[it->first] = it->second;
+    }
+    check_lookups(tree, expected, n / 2, 1);
+}
+
+TEST(BppTreeTest, TestHashedConcurrentConstLookups) {
+    using TreeType = BppTreeMap<int32_t, int32_t>::mixins<HashedBuilder<>>;
+    TreeType::Transient tree{};
+    std::map<int32_t, int32_t> expected{};
+    for (int32_t i = 0; i < 10000; ++i) {
+        tree.insert_or_assign(i * 3, i);
+        expected[i * 3] = i;
+    }
+    // half of the keys are in the index, const lookups must find both halves without adding to it
+    for (int32_t key = 0; key < 30000; key += 6) {
+        ASSERT_TRUE(tree.contains(key));
+    }
+    std::vector<std::thread> threads{};
+    for (int32_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&tree, &expected, t]() { check_lookups(std::as_const(tree), expected, 30000, 5 + t); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    check_lookups(tree, expected, 30000, 1);
+}
+
+TEST(BppTreeTest, TestHashedIndexSurvivesModifications) {
+    using TreeType = BppTreeMap<int32_t, int32_t>::mixins<HashedBuilder<>>;
+    TreeType::Transient tree{};
+    std::map<int32_t, int32_t> expected{};
+    for (int32_t i = 0; i < 10000; ++i) {
+        tree.insert_or_assign(i * 4, i);
+        expected[i * 4] = i;
+    }
+    for (int32_t key = 0; key < 40000; key += 4) {
+        ASSERT_EQ(tree.at_key(key), key / 4);
+    }
+    // inserts between the keys split leaves and move keys within them. lookups still go through the index, except
+    // for the first lookup of a key that was moved to a new leaf
+    hashed_index_hits = 0;
+    int lookups = 0;
+    for (int32_t i = 0; i < 10000; ++i) {
+        tree.insert_or_assign(i * 4 + 1, -i);
+        expected[i * 4 + 1] = -i;
+        for (int32_t key : {i * 4, (i * 7919) % 10000 * 4, (i * 104729) % 10000 * 4}) {
+            ASSERT_EQ(tree.at_key(key), key / 4);
+            ASSERT_TRUE(tree.contains(key));
+            lookups += 2;
+        }
+    }
+    EXPECT_GT(hashed_index_hits, lookups / 2);
+    // erasing keys leaves their entries in the index, and erasing every key of some leaves removes the leaves
+    for (int32_t key = 10000; key < 20000; ++key) {
+        if (expected.erase(key) > 0) {
+            tree.erase_key(key);
+        }
+    }
+    for (int32_t i = 0; i < 1000; ++i) {
+        tree.erase_key(i * 4 + 1);
+        expected.erase(i * 4 + 1);
+    }
+    check_lookups(tree, expected, 40000, 1);
+    check_lookups(std::as_const(tree), expected, 40000, 3);
+    // assigning in place and inserting after a snapshot
+    auto snapshot = tree.persistent();
+    for (int32_t key = 0; key < 40000; key += 8) {
+        if (expected.count(key) > 0) {
+            tree.assign_v(key, 7);
+            expected[key] = 7;
+        }
+        tree.insert_or_assign(key + 2, 3);
+        expected[key + 2] = 3;
+        ASSERT_EQ(tree.at_key(key + 2), 3);
+    }
+    check_lookups(tree, expected, 40000, 1);
+    EXPECT_EQ(snapshot.at_key(8), 2);
+}
@@ -0,0 +1,99 @@
+#include <vector>
+#include <cstring>
+#include <thread>
+#include "gtest/gtest.h"
+#include "bpptree/detail/huge_page_arena.hpp"
+
+using namespace bpptree::detail;
+
+TEST(BppTreeTest, TestHugePageArena) {
+    HugePageArena arena{};
+    std::vector<std::pair<unsigned char*, size_t>> live{};
+    size_t const sizes[] = {200, 512, 4096};
+    for (size_t i = 0; i < 20000; ++i) {
+        size_t bytes = sizes[i % 3];
+        auto* p = static_cast<unsigned char*>(arena.allocate(bytes, 64));
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p) % 64);
+        std::memset(p, static_cast<int>(i & 0xff), bytes);
+        live.emplace_back(p, i);
+    }
+    size_t chunks = arena.chunks();
+    // every node of a chunk has to be released before the chunk can be returned
+    for (size_t round = 0; round < 5; ++round) {
+        std::vector<std::pair<unsigned char*, size_t>> kept{};
+        for (size_t i = 0; i < live.size(); ++i) {
+            auto [p, tag] = live[i];
+            size_t bytes = sizes[tag % 3];
+            for (size_t j = 0; j < bytes; j += 97) {
+                ASSERT_EQ(static_cast<unsigned char>(tag & 0xff), p[j]);
+            }
+            if (static_cast<size_t>(rand()) % 2 == 0) {
+                arena.release(p);
+            } else {
+                kept.emplace_back(p, tag);
+            }
+        }
+        live = std::move(kept);
+        size_t added = 20000 - live.size();
+        for (size_t i = 0; i < added; ++i) {
+            size_t tag = round * 100000 + i;
+            size_t bytes = sizes[tag % 3];
+            auto* p = static_cast<unsigned char*>(arena.allocate(bytes, 64));
+            std::memset(p, static_cast<int>(tag & 0xff), bytes);
+            live.emplace_back(p, tag);
+        }
+        // released nodes are reused, so the arena does not grow while the number of live nodes stays the same
+        EXPECT_LE(arena.chunks(), chunks + 3);
+    }
+    for (auto [p, tag] : live) {
+        arena.release(p);
+    }
+    // one chunk per node size is kept
+    EXPECT_LE(arena.chunks(), 3u);
+}
+
+TEST(BppTreeTest, TestHugePageArenaThreads) {
+    HugePageArena arena{};
+    size_t const sizes[] = {200, 4096};
+    size_t const threads = 4;
+    size_t const count = 20000;
+    std::vector<std::vector<unsigned char*>> allocated(threads);
+    auto allocate = [&arena, &sizes, count](std::vector<unsigned char*>& out, size_t thread) {
+        for (size_t i = 0; i < count; ++i) {
+            auto* p = static_cast<unsigned char*>(arena.allocate(sizes[i % 2], 64));
+            std::memset(p, static_cast<int>(thread), sizes[i % 2]);
+            out.push_back(p);
+        }
+    };
+    std::vector<std::thread> workers{};
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&allocate, &allocated, t]() { allocate(allocated[t], t); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    // each thread releases the nodes another thread allocated while allocating and releasing nodes of its own
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&arena, &allocate, &allocated, &sizes, t, threads, count]() {
+            size_t other = (t + 1) % threads;
+            std::vector<unsigned char*> own{};
+            allocate(own, t + threads);
+            for (size_t i = 0; i < count; ++i) {
+                unsigned char* p = allocated[other][i];
+                unsigned char* q = own[i];
+                for (size_t j = 0; j < sizes[i % 2]; j += 97) {
+                    ASSERT_EQ(static_cast<unsigned char>(other), p[j]);
+                    ASSERT_EQ(static_cast<unsigned char>(t + threads), q[j]);
+                }
+                arena.release(p);
+                arena.release(q);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    // one chunk per node size is kept
+    EXPECT_LE(arena.chunks(), 2u);
+}
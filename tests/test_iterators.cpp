@@ -1,6 +1,8 @@
 #include "bpptree/bpptree.hpp"
+#include "bpptree/offset_leaves.hpp"
 #include <chrono>
 #include <iterator>
+#include <vector>
 #include "gtest/gtest.h"
 #include "test_common.hpp"
 
@@ -68,3 +70,261 @@ TEST(BppTreeTest, TestIterators) {
         EXPECT_EQ(it2, rbegin);
     }
 }
+
+TEST(BppTreeTest, TestIteratorLeafCrossings) {
+    SummedIndexedTree<uint32_t>::Transient tree{};
+    for (uint32_t i = 0; i < 65536; ++i) {
+        tree.push_back(i);
+    }
+    auto check_scans = [](auto const& t, uint32_t size) {
+        auto signed_size = static_cast<ssize>(size);
+        uint32_t expected = 0;
+        for (auto it = t.cbegin(); it != t.cend(); ++it) {
+            ASSERT_EQ(*it, expected);
+            ++expected;
+        }
+        ASSERT_EQ(expected, size);
+        for (auto it = t.crbegin(); it != t.crend(); ++it) {
+            --expected;
+            ASSERT_EQ(*it, expected);
+        }
+        ASSERT_EQ(expected, 0u);
+        for (ssize step : {3, 127, 129, 1000}) {
+            auto it = t.cbegin();
+            for (ssize i = 0; i < signed_size; i += step) {
+                ASSERT_EQ(*it, static_cast<uint32_t>(i));
+                it += step;
+            }
+            ssize last = (signed_size - 1) / step * step;
+            it = t.cbegin();
+            it += last;
+            for (ssize i = last - step; i >= 0; i -= step) {
+                it -= step;
+                ASSERT_EQ(*it, static_cast<uint32_t>(i));
+            }
+        }
+    };
+    check_scans(tree, 65536);
+    if constexpr (true) {
+        SummedIndexedTree<uint32_t>::Persistent persistent = tree.persistent();
+        check_scans(persistent, 65536);
+    }
+
+    // assigning copies the nodes shared with a snapshot, and erasing and inserting through the iterator merges and
+    // splits the nodes around it. neither may leave the iterator with a stale cached parent.
+    auto it = tree.begin();
+    it += 1000;
+    for (uint32_t i = 1000; i < 5096; ++i) {
+        ASSERT_EQ(*it, i);
+        if (i % 64 == 0) {
+            for (uint32_t j = 0; j < 300; ++j) {
+                tree.erase(it);
+            }
+            for (uint32_t j = 300; j > 0; --j) {
+                tree.insert(it, i + j - 1);
+            }
+        } else {
+            SummedIndexedTree<uint32_t>::Persistent snapshot = tree.persistent();
+            tree.assign_index(i + 1, i + 1);
+        }
+        ++it;
+    }
+    for (uint32_t i = 5096; i < 65536; ++i) {
+        ASSERT_EQ(*it, i);
+        ++it;
+    }
+    ASSERT_EQ(it, tree.end());
+    check_scans(tree, 65536);
+}
+
+template <typename Tree>
+void check_chunks(Tree const& tree, std::vector<uint32_t> const& expected) {
+    auto size = static_cast<ssize>(expected.size());
+    for (ssize first : {ssize(0), ssize(1), ssize(125), ssize(126), size / 3, size - 1, size}) {
+        for (ssize last : {first, first + 1, first + 200, size / 2, size - 1, size}) {
+            if (first < 0 || last < first || last > size) {
+                continue;
+            }
+            auto begin = tree.cbegin();
+            begin += first;
+            auto end = tree.cbegin();
+            end += last;
+            std::vector<uint32_t> values{};
+            size_t chunks = 0;
+            tree.for_each_chunk(begin, end, [&](Span<uint32_t const> chunk) {
+                ASSERT_FALSE(chunk.empty());
+                values.insert(values.end(), chunk.begin(), chunk.end());
+                ++chunks;
+            });
+            ASSERT_EQ(values, std::vector<uint32_t>(expected.begin() + first, expected.begin() + last));
+            ASSERT_LE(chunks, values.size());
+        }
+    }
+    std::vector<uint32_t> values{};
+    tree.for_each_chunk([&](Span<uint32_t const> chunk) {
+        values.insert(values.end(), chunk.begin(), chunk.end());
+    });
+    ASSERT_EQ(values, expected);
+}
+
+TEST(BppTreeTest, TestForEachChunk) {
+    SummedIndexedTree<uint32_t>::Transient tree{};
+    check_chunks(tree, {});
+    std::vector<uint32_t> expected{};
+    for (uint32_t i = 0; i < 100000; ++i) {
+        tree.push_back(i);
+        expected.push_back(i);
+    }
+    check_chunks(tree, expected);
+    check_chunks(tree.persistent(), expected);
+
+    // values in offset leaves don't start at the beginning of the leaf
+    using OffsetTree = BppTree<uint32_t, 512, 512, 6>::mixins<OffsetLeavesBuilder, IndexedBuilder<>>;
+    OffsetTree::Transient offset_tree{};
+    std::vector<uint32_t> offset_expected{};
+    for (uint32_t i = 0; i < 50000; ++i) {
+        offset_tree.push_front(i);
+        offset_tree.push_back(i);
+    }
+    for (uint32_t i = 50000; i > 0; --i) {
+        offset_expected.push_back(i - 1);
+    }
+    for (uint32_t i = 0; i < 50000; ++i) {
+        offset_expected.push_back(i);
+    }
+    check_chunks(offset_tree, offset_expected);
+}
+
+TEST(BppTreeTest, TestForEachReduce) {
+    SummedIndexedTree<uint32_t>::Transient tree{};
+    tree.for_each([](uint32_t) { FAIL(); });
+    ASSERT_EQ(tree.reduce(uint64_t(7), std::plus<>()), 7u);
+    for (uint32_t i = 0; i < 100000; ++i) {
+        tree.push_back(i);
+    }
+    std::vector<uint32_t> values{};
+    tree.for_each([&values](uint32_t v) { values.push_back(v); });
+    ASSERT_EQ(values.size(), tree.size());
+    for (uint32_t i = 0; i < 100000; ++i) {
+        ASSERT_EQ(values[i], i);
+    }
+    auto persistent = tree.persistent();
+    ASSERT_EQ(persistent.reduce(uint64_t(0), std::plus<>()), uint64_t(99999) * 100000 / 2);
+
+    // ranges starting and ending in every position of a leaf and spanning zero, one or many leaves
+    for (ssize first = 0; first < 2000; first += 37) {
+        for (ssize last = first; last < 100000; last = last * 3 + 1) {
+            uint64_t expected = 0;
+            for (ssize i = first; i < last; ++i) {
+                expected += static_cast<uint64_t>(i);
+            }
+            uint64_t sum = tree.reduce(tree.begin() + first, tree.begin() + last, uint64_t(0), std::plus<>());
+            ASSERT_EQ(sum, expected);
+            ssize count = 0;
+            persistent.for_each(persistent.begin() + first, persistent.begin() + last, [&count, first](uint32_t v) {
+                ASSERT_EQ(v, static_cast<uint64_t>(first + count));
+                ++count;
+            });
+            ASSERT_EQ(count, last - first);
+        }
+    }
+}
+
+template <typename Tree>
+void check_split_range(Tree const& tree, ssize first, ssize last, size_t k, bool exact) {
+    auto begin = tree.begin();
+    std::advance(begin, first);
+    auto end = begin;
+    std::advance(end, last - first);
+    auto ranges = tree.split_range(begin, end, k);
+    ASSERT_EQ(ranges.size(), k);
+    auto expected = begin;
+    auto total = static_cast<size_t>(last - first);
+    auto value = static_cast<uint32_t>(first);
+    for (auto const& range : ranges) {
+        ASSERT_EQ(range.begin(), expected);
+        size_t count = 0;
+        for (auto it = range.begin(); it != range.end(); ++it) {
+            ASSERT_EQ(*it, value);
+            ++value;
+            ++count;
+        }
+        if (exact) {
+            ASSERT_LE(count, total / k + 1);
+            ASSERT_GE(count, total / k);
+        } else {
+            ASSERT_LE(count, total * 2 / k + 256);
+        }
+        std::advance(expected, static_cast<ssize>(count));
+    }
+    ASSERT_EQ(expected, end);
+}
+
+template <typename It>
+size_t split_all(SplittableRange<It> range) {
+    if (!range.is_divisible()) {
+        return range.empty() ? 0 : 1;
+    }
+    auto right = range.split();
+    EXPECT_FALSE(range.empty());
+    EXPECT_FALSE(right.empty());
+    EXPECT_EQ(range.end(), right.begin());
+    return split_all(range) + split_all(right);
+}
+
+TEST(BppTreeTest, TestSplitRange) {
+    SummedIndexedTree<uint32_t>::Transient indexed{};
+    BppTree<uint32_t, 512, 128>::Transient plain{};
+    ASSERT_EQ(indexed.split_range(indexed.begin(), indexed.end(), 4).size(), 4u);
+    for (uint32_t i = 0; i < 100000; ++i) {
+        indexed.push_back(i);
+        plain.push_back(i);
+    }
+    for (size_t k : {1u, 2u, 3u, 8u, 24u, 1000u}) {
+        check_split_range(indexed, 0, 100000, k, true);
+        check_split_range(indexed, 1234, 56789, k, true);
+        check_split_range(indexed, 500, 510, k, true);
+        check_split_range(plain, 0, 100000, k, false);
+        check_split_range(plain, 1234, 56789, k, false);
+        check_split_range(plain, 500, 510, k, false);
+    }
+    ASSERT_EQ(split_all(SplittableRange(indexed.begin() + 100, indexed.begin() + 3000)), 2900u);
+    ASSERT_EQ(split_all(SplittableRange(plain.cbegin(), plain.cend())), 100000u);
+}
+
+TEST(BppTreeTest, TestIteratorsSurviveAssign) {
+    SummedIndexedTree<uint32_t>::Transient tree{};
+    for (uint32_t i = 0; i < 10000; ++i) {
+        tree.push_back(i);
+    }
+    auto it = tree.cbegin() + 5000;
+    auto const* leaf = it.leaf;
+    // assigning in place moves no values, so iterators don't have to find their leaf again
+    tree.assign_index(5000, 1u);
+    tree[10] = 7u;
+    ASSERT_EQ(tree.cbegin().mod_count, it.mod_count);
+    ASSERT_EQ(*it, 1u);
+    ASSERT_EQ(it.leaf, leaf);
+
+    // assigning into a leaf shared with a snapshot copies it
+    auto snapshot = tree.persistent();
+    tree.assign_index(5001, 2u);
+    ASSERT_NE(tree.cbegin().mod_count, it.mod_count);
+    ASSERT_EQ(*it, 1u);
+    ASSERT_NE(it.leaf, leaf);
+    ++it;
+    ASSERT_EQ(*it, 2u);
+    // the snapshot keeps the old value. the index comes from the iterator so -O3 doesn't propagate a constant into
+    // the leaf root branch of dispatch and warn about it with -Warray-bounds
+    ASSERT_EQ(snapshot[tree.order(it)], 5001u);
+
+    for (auto it2 = tree.begin(); it2 != tree.end(); ++it2) {
+        uint32_t v = *it2;
+        *it2 = v * 2;
+    }
+    ASSERT_EQ(tree.sum(), (snapshot.sum() - 5001 + 2) * 2);
+    for (uint32_t i = 0; i < 10000; ++i) {
+        uint32_t expected = i == 10 ? 7 : i == 5000 ? 1 : i == 5001 ? 2 : i;
+        ASSERT_EQ(tree[i], expected * 2);
+    }
+}
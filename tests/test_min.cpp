@@ -2,8 +2,11 @@
 #include "bpptree/indexed.hpp"
 #include "bpptree/min.hpp"
 #include "bpptree/max.hpp"
+#include "bpptree/summed.hpp"
 #include <chrono>
 #include <vector>
+#include <numeric>
+#include <algorithm>
 #include <iterator>
 #include "gtest/gtest.h"
 #include "test_common.hpp"
@@ -209,3 +212,96 @@ TEST(BppTreeTest, TestMaxPersistent) {
         EXPECT_EQ(*tree.max_element_const(tree.begin()+i, tree.end()), tree[i]);
     }
 }
+
+TEST(BppTreeTest, TestMinMaxRandomModifications) {
+    using TreeType = BppTree<uint32_t, 128, 128, 6>::mixins<IndexedBuilder<>, MinBuilder<>, MaxBuilder<>>;
+    TreeType::Transient tree{};
+    TreeType::Persistent snapshot{};
+    Vector<uint32_t> vec{};
+    for (uint32_t i = 0; i < 20000; ++i) {
+        // a small range of values means lots of ties, which must resolve to the first min/max element
+        auto r = static_cast<uint32_t>(rand()) % 64;
+        auto op = static_cast<uint32_t>(rand()) % 4;
+        if (op == 0 && !vec.empty()) {
+            size_t index = static_cast<size_t>(rand()) % vec.size();
+            tree.erase_index(index);
+            vec.erase(vec.begin() + signed_cast(index));
+        } else if (op == 1 && !vec.empty()) {
+            size_t index = static_cast<size_t>(rand()) % vec.size();
+            tree[index] = r;
+            vec[index] = r;
+        } else {
+            size_t index = vec.empty() ? 0 : static_cast<size_t>(rand()) % (vec.size() + 1);
+            tree.insert_index(index, r);
+            vec.insert(vec.begin() + signed_cast(index), r);
+        }
+        if (i % 1000 == 0) {
+            // modifications after this copy nodes out of the snapshot instead of changing them in place
+            snapshot = tree.persistent();
+            tree = snapshot.transient();
+        }
+        if (vec.empty()) {
+            continue;
+        }
+        ASSERT_EQ(tree.min(), *std::min_element(vec.begin(), vec.end()));
+        ASSERT_EQ(tree.max(), *std::max_element(vec.begin(), vec.end()));
+        ASSERT_EQ(tree.min_element() - tree.begin(), std::min_element(vec.begin(), vec.end()) - vec.begin());
+        ASSERT_EQ(tree.max_element() - tree.begin(), std::max_element(vec.begin(), vec.end()) - vec.begin());
+        if (i % 97 == 0) {
+            size_t begin = static_cast<size_t>(rand()) % vec.size();
+            size_t end = begin + 1 + static_cast<size_t>(rand()) % (vec.size() - begin);
+            auto vec_begin = vec.begin() + signed_cast(begin);
+            auto vec_end = vec.begin() + signed_cast(end);
+            auto tree_begin = tree.begin() + signed_cast(begin);
+            auto tree_end = tree.begin() + signed_cast(end);
+            ASSERT_EQ(tree.min(tree_begin, tree_end), *std::min_element(vec_begin, vec_end));
+            ASSERT_EQ(tree.max(tree_begin, tree_end), *std::max_element(vec_begin, vec_end));
+            ASSERT_EQ(*tree.min_element(tree_begin, tree_end), *std::min_element(vec_begin, vec_end));
+            ASSERT_EQ(*tree.max_element(tree_begin, tree_end), *std::max_element(vec_begin, vec_end));
+        }
+    }
+}
+
+TEST(BppTreeTest, TestUpdateChunks) {
+    using TreeType = BppTree<uint32_t, 128, 128, 6>::mixins<SummedBuilder<>, IndexedBuilder<>, MinBuilder<>, MaxBuilder<>>;
+    TreeType::Transient tree{};
+    Vector<uint32_t> vec{};
+    for (uint32_t i = 0; i < 20000; ++i) {
+        auto r = static_cast<uint32_t>(rand()) % 1000;
+        tree.push_back(r);
+        vec.push_back(r);
+    }
+    TreeType::Persistent snapshot = tree.persistent();
+    Vector<uint32_t> snapshot_vec = vec;
+    for (uint32_t i = 0; i < 200; ++i) {
+        size_t begin = static_cast<size_t>(rand()) % vec.size();
+        size_t end = begin + static_cast<size_t>(rand()) % (std::min(vec.size() - begin, size_t(3000)) + 1);
+        auto op = static_cast<uint32_t>(rand()) % 3;
+        auto apply = [op](uint32_t& v) {
+            v = op == 0 ? v * 2 % 1000 : op == 1 ? v + 1 : 0;
+        };
+        std::for_each(vec.begin() + signed_cast(begin), vec.begin() + signed_cast(end), apply);
+        size_t updated = 0;
+        tree.update_chunks(tree.begin() + signed_cast(begin), tree.begin() + signed_cast(end), [&](Span<uint32_t> chunk) {
+            std::for_each(chunk.begin(), chunk.end(), apply);
+            updated += chunk.size();
+        });
+        ASSERT_EQ(updated, end - begin);
+        if (i % 50 == 0) {
+            // later updates copy nodes out of the snapshot instead of changing them in place
+            snapshot = tree.persistent();
+            snapshot_vec = vec;
+        }
+        ASSERT_TRUE(std::equal(tree.cbegin(), tree.cend(), vec.begin(), vec.end()));
+        ASSERT_EQ(tree.sum(), std::accumulate(vec.begin(), vec.end(), uint32_t(0)));
+        size_t mid = static_cast<size_t>(rand()) % vec.size();
+        ASSERT_EQ(tree.sum_exclusive(tree.cbegin() + signed_cast(mid)),
+                  std::accumulate(vec.begin(), vec.begin() + signed_cast(mid), uint32_t(0)));
+        ASSERT_EQ(tree.min(), *std::min_element(vec.begin(), vec.end()));
+        ASSERT_EQ(tree.max(), *std::max_element(vec.begin(), vec.end()));
+        ASSERT_EQ(tree.min_element() - tree.begin(), std::min_element(vec.begin(), vec.end()) - vec.begin());
+        ASSERT_EQ(tree.max_element() - tree.begin(), std::max_element(vec.begin(), vec.end()) - vec.begin());
+        ASSERT_TRUE(std::equal(snapshot.begin(), snapshot.end(), snapshot_vec.begin(), snapshot_vec.end()));
+        ASSERT_EQ(snapshot.sum(), std::accumulate(snapshot_vec.begin(), snapshot_vec.end(), uint32_t(0)));
+    }
+}
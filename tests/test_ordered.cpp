@@ -2,8 +2,10 @@
 #include <chrono>
 #include <vector>
 #include <iterator>
+#include <map>
 #include "gtest/gtest.h"
 #include "test_common.hpp"
+#include "bpptree/adaptive_split.hpp"
 
 using namespace std;
 
@@ -179,6 +181,70 @@ TEST(BppTreeTest, TestOrderedPersistentBinarySearch) {
     test_ordered_persistent<true>();
 }
 
+template <typename TreeType>
+void check_search_mode(TreeType const& tree, std::map<int32_t, int32_t> const& map) {
+    ASSERT_EQ(tree.size(), map.size());
+    for (int32_t key = -10; key < 20010; key += 3) {
+        auto expected = map.lower_bound(key);
+        auto it = tree.lower_bound(key);
+        if (expected == map.end()) {
+            ASSERT_TRUE(it == tree.end());
+        } else {
+            ASSERT_EQ(it->first, expected->first);
+            ASSERT_EQ(it->second, expected->second);
+        }
+        auto expected_upper = map.upper_bound(key);
+        auto upper = tree.upper_bound(key);
+        if (expected_upper == map.end()) {
+            ASSERT_TRUE(upper == tree.end());
+        } else {
+            ASSERT_EQ(upper->first, expected_upper->first);
+        }
+        ASSERT_EQ(tree.contains(key), map.find(key) != map.end());
+    }
+}
+
+template <SearchMode search_mode>
+void test_search_mode() {
+    static constexpr int n = 100*1000;
+    Vector<int32_t> const& rand_ints = RandInts<int32_t, n>::ints;
+
+    using TreeType = typename BppTreeMap<int32_t, int32_t>::template search_mode<search_mode>::template depth_limit<6>;
+    typename TreeType::Transient tree{};
+    std::map<int32_t, int32_t> map{};
+    for (int i = 0; i < n; ++i) {
+        int32_t key = rand_ints[i] % 20000;
+        tree.insert_or_assign(key, i);
+        map[key] = i;
+    }
+    check_search_mode(tree, map);
+    typename TreeType::Persistent persistent = tree.persistent();
+    auto erased = map;
+    for (int32_t key = 0; key < 20000; key += 2) {
+        persistent = persistent.erase_key(key);
+        erased.erase(key);
+    }
+    check_search_mode(persistent, erased);
+    check_search_mode(tree, map);
+}
+
+// the 4th parameter of BppTreeMap and BppTreeSet still selects binary search
+static_assert(std::is_same_v<BppTreeMap<int32_t, int32_t, MinComparator, true>::Transient,
+        BppTreeMap<int32_t, int32_t>::search_mode<SearchMode::binary>::Transient>);
+static_assert(std::is_same_v<BppTreeSet<int32_t, MinComparator, false>::Transient, BppTreeSet<int32_t>::Transient>);
+
+TEST(BppTreeTest, TestBranchlessSearch) {
+    test_search_mode<SearchMode::branchless>();
+}
+
+TEST(BppTreeTest, TestInterpolationSearch) {
+    test_search_mode<SearchMode::interpolation>();
+}
+
+TEST(BppTreeTest, TestLearnedSearch) {
+    test_search_mode<SearchMode::learned>();
+}
+
 TEST(BppTreeTest, TestOrderedTransientSet) {
     static constexpr int n = 100*1000;
     Vector<int32_t> const& rand_ints = RandInts<int32_t, n>::ints;
@@ -209,3 +275,205 @@ TEST(BppTreeTest, TestOrderedTransientSet) {
         EXPECT_TRUE(set.find(i) != set.end());
     }
 }
+
+template <typename TreeType>
+void check_skewed_keys(TreeType const& tree, std::set<double> const& set) {
+    EXPECT_EQ(tree.size(), set.size());
+    for (int32_t i = -1001; i <= 1001; ++i) {
+        double d = static_cast<double>(i);
+        double key = d * d * d + (i % 2 == 0 ? 0.5 : 0.0);
+        auto expected = set.lower_bound(key);
+        auto it = tree.lower_bound(key);
+        if (expected == set.end()) {
+            EXPECT_EQ(it, tree.end());
+        } else {
+            EXPECT_EQ(*it, *expected);
+        }
+        auto expected_upper = set.upper_bound(key);
+        auto upper = tree.upper_bound(key);
+        if (expected_upper == set.end()) {
+            EXPECT_EQ(upper, tree.end());
+        } else {
+            EXPECT_EQ(*upper, *expected_upper);
+        }
+        EXPECT_EQ(tree.contains(key), set.find(key) != set.end());
+    }
+}
+
+template <SearchMode search_mode>
+void test_skewed_keys() {
+    static constexpr int n = 20*1000;
+    Vector<int32_t> const& rand_ints = RandInts<int32_t, n>::ints;
+
+    using TreeType = typename BppTreeSet<double>::template search_mode<search_mode>::template leaf_node_bytes<4096>::template depth_limit<6>;
+    typename TreeType::Transient tree{};
+    std::set<double> set{};
+    for (int32_t i : rand_ints) {
+        // cubing clusters most keys near zero so estimates from the key values are far from the actual positions
+        double d = static_cast<double>(i % 1000);
+        tree.insert_or_assign(d * d * d);
+        set.insert(d * d * d);
+    }
+    check_skewed_keys(tree, set);
+    typename TreeType::Persistent persistent = tree.persistent();
+    check_skewed_keys(persistent, set);
+    // modifying the transient tree again must not use the models of the nodes shared with the snapshot
+    for (int32_t i = 0; i < 1000; i += 3) {
+        double d = static_cast<double>(i);
+        tree.erase_key(d * d * d);
+        set.erase(d * d * d);
+        tree.insert_or_assign(d * d * d + 0.5);
+        set.insert(d * d * d + 0.5);
+    }
+    check_skewed_keys(tree, set);
+    check_skewed_keys(tree.persistent(), set);
+
+    using StringTreeType = typename BppTreeSet<std::string>::template search_mode<search_mode>::Persistent;
+    auto strings = StringTreeType().transient();
+    for (int32_t i = 0; i < 1000; ++i) {
+        strings.insert_or_assign(std::to_string(i));
+    }
+    StringTreeType persistent_strings = strings.persistent();
+    for (int32_t i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(persistent_strings.contains(std::to_string(i)));
+    }
+    EXPECT_FALSE(persistent_strings.contains("1000"));
+}
+
+TEST(BppTreeTest, TestInterpolationSearchSkewedKeys) {
+    test_skewed_keys<SearchMode::interpolation>();
+
+    // a few huge keys at the end put every estimate near the front, so the correction has to give up and fall back
+    std::vector<double> keys{};
+    for (int i = 0; i < 500; ++i) {
+        keys.push_back(i < 490 ? static_cast<double>(i) : 1e12 * i);
+    }
+    auto get = [&keys](IndexType i) { return keys[static_cast<size_t>(i)]; };
+    auto less = [](double a, double b) { return a < b; };
+    for (double search_val : {-1.0, 0.0, 3.5, 250.0, 489.0, 489.5, 1e12, 4.9e14, 5e14}) {
+        auto expected = std::lower_bound(keys.begin(), keys.end(), search_val) - keys.begin();
+        ASSERT_EQ(interpolation_lower_bound(0, 500, get, search_val, less), expected);
+        ASSERT_EQ(interpolation_lower_bound(10, 480, get, search_val, less), std::clamp(expected, ssize(10), ssize(490)));
+    }
+}
+
+TEST(BppTreeTest, TestLearnedSearchSkewedKeys) {
+    test_skewed_keys<SearchMode::learned>();
+}
+
+template <SearchMode search_mode>
+void test_find_sorted() {
+    using TreeType = typename BppTreeMap<int32_t, int32_t>::template search_mode<search_mode>::template depth_limit<6>::Transient;
+    TreeType tree{};
+    for (int32_t i = 0; i < 100*1000; i += 2) {
+        tree.insert_or_assign(i, -i);
+    }
+    std::vector<int32_t> keys{};
+    for (int32_t i = -5; i < 100*1000 + 5; i += 3) {
+        keys.push_back(i);
+        if (i % 7 == 0) {
+            keys.push_back(i);
+        }
+    }
+    std::vector<typename TreeType::iterator> results{};
+    tree.find_sorted(keys.begin(), keys.end(), std::back_inserter(results));
+    ASSERT_EQ(keys.size(), results.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(tree.find(keys[i]), results[i]);
+        if (results[i] != tree.end()) {
+            EXPECT_EQ(keys[i], results[i]->first);
+            EXPECT_EQ(-keys[i], results[i]->second);
+        }
+    }
+    auto persistent = tree.persistent();
+    std::vector<decltype(persistent.cbegin())> const_results{};
+    std::as_const(persistent).find_sorted(keys.begin(), keys.end(), std::back_inserter(const_results));
+    ASSERT_EQ(keys.size(), const_results.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(persistent.find(keys[i]), const_results[i]);
+    }
+}
+
+TEST(BppTreeTest, TestFindSortedLinearSearch) {
+    test_find_sorted<SearchMode::linear>();
+}
+
+TEST(BppTreeTest, TestFindSortedBinarySearch) {
+    test_find_sorted<SearchMode::binary>();
+}
+
+TEST(BppTreeTest, TestFindSortedBranchlessSearch) {
+    test_find_sorted<SearchMode::branchless>();
+}
+
+TEST(BppTreeTest, TestFindSortedInterpolationSearch) {
+    test_find_sorted<SearchMode::interpolation>();
+}
+
+TEST(BppTreeTest, TestFindSortedLearnedSearch) {
+    test_find_sorted<SearchMode::learned>();
+}
+
+template <typename TreeType>
+size_t build_split_pattern(int pattern) {
+    static constexpr int32_t n = 100*1000;
+    Vector<int32_t> const& rand_ints = RandInts<int32_t, n>::ints;
+    reset_counters();
+    typename TreeType::Transient tree{};
+    std::map<int32_t, int32_t> expected{};
+    auto insert = [&](int32_t key) {
+        tree.insert_or_assign(key, -key);
+        expected.insert_or_assign(key, -key);
+        if (expected.size() % 1000 == 0) {
+            // exercises the copy on write paths
+            auto snapshot = tree.persistent();
+        }
+    };
+    for (int32_t i = 0; i <= 16; ++i) {
+        insert(i * n);
+    }
+    for (int32_t i = 1; i < n; ++i) {
+        switch (pattern) {
+            case 0:
+                insert(-i);
+                break;
+            case 1:
+                insert(8 * n + i);
+                break;
+            case 2:
+                insert(9 * n - i);
+                break;
+            case 3:
+                insert(16 * n + i);
+                break;
+            default:
+                insert(rand_ints[static_cast<size_t>(i)]);
+        }
+    }
+    EXPECT_EQ(expected.size(), tree.size());
+    auto it = tree.cbegin();
+    for (auto const& [key, value] : expected) {
+        EXPECT_EQ(key, it->first);
+        EXPECT_EQ(value, it->second);
+        ++it;
+    }
+    EXPECT_EQ(tree.cend(), it);
+    return static_cast<size_t>(allocations - deallocations);
+}
+
+TEST(BppTreeTest, TestAdaptiveSplit) {
+    using DefaultTree = BppTree<std::pair<int32_t, int32_t>, 512, 512, 6>::mixins<OrderedBuilder<>>;
+    using AdaptiveTree = BppTree<std::pair<int32_t, int32_t>, 512, 512, 6>::mixins<OrderedBuilder<>, AdaptiveSplitBuilder>;
+    for (int pattern = 0; pattern < 5; ++pattern) {
+        size_t default_nodes = build_split_pattern<DefaultTree>(pattern);
+        size_t adaptive_nodes = build_split_pattern<AdaptiveTree>(pattern);
+        cout << "pattern " << pattern << " nodes: " << default_nodes << " default, " << adaptive_nodes << " adaptive" << endl;
+        if (pattern < 3) {
+            EXPECT_LT(adaptive_nodes * 10, default_nodes * 6);
+        } else {
+            // appends already fill each node and random inserts are split in the middle either way, so the only
+            // difference is the few values per node taken up by the run tracking
+            EXPECT_LT(adaptive_nodes * 100, default_nodes * 105);
+        }
+    }
+}
@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_common.hpp"
+#include "bpptree/parallel.hpp"
+
+using namespace std;
+
+using ParallelIndexedTree = BppTree<uint32_t, 512, 128>::mixins<IndexedBuilder<>, ParallelBuilder>;
+
+using ParallelMap = BppTreeMap<uint32_t, uint32_t>::mixins<ParallelBuilder>;
+
+TEST(BppTreeTest, TestParallelForEachReduce) {
+    ThreadPool pool(4);
+    auto inline_executor = [](std::function<void()> const& task) { task(); };
+    ParallelIndexedTree::Transient tree{};
+    ASSERT_EQ(tree.parallel_reduce(uint64_t(5), std::plus<>(), pool), 5u);
+    tree.parallel_for_each([](uint32_t) { FAIL(); }, pool);
+    uint64_t expected = 0;
+    for (uint32_t i = 0; i < 1000000; ++i) {
+        tree.push_back(i * 7);
+        expected += i * 7;
+    }
+    auto persistent = tree.persistent();
+    std::atomic<uint64_t> sum{0};
+    std::atomic<size_t> count{0};
+    auto add = [&sum, &count](uint32_t v) {
+        sum += v;
+        ++count;
+    };
+    tree.parallel_for_each(add, pool);
+    persistent.parallel_for_each(add);
+    tree.parallel_for_each(add, inline_executor);
+    ASSERT_EQ(sum, expected * 3);
+    ASSERT_EQ(count, tree.size() * 3);
+    ASSERT_EQ(tree.parallel_reduce(uint64_t(1), std::plus<>(), pool), expected + 1);
+    ASSERT_EQ(persistent.parallel_reduce(uint64_t(0), std::plus<>()), expected);
+    ASSERT_EQ(tree.parallel_transform_reduce(uint64_t(0), std::plus<>(), [](uint32_t v) { return v % 2; }, pool), 500000u);
+
+    // the values are combined in order, so reduce only has to be associative
+    ParallelMap::Transient map{};
+    for (uint32_t i = 0; i < 20000; ++i) {
+        map.insert_or_assign(i, i % 10);
+    }
+    auto digits = map.parallel_transform_reduce(
+            std::string(),
+            [](std::string a, std::string const& b) { return a + b; },
+            [](auto const& pair) { return std::to_string(pair.second); },
+            pool);
+    ASSERT_EQ(digits.size(), 20000u);
+    for (size_t i = 0; i < digits.size(); ++i) {
+        ASSERT_EQ(digits[i], static_cast<char>('0' + i % 10));
+    }
+}
+
+TEST(BppTreeTest, TestParallelException) {
+    ThreadPool pool(3);
+    ParallelIndexedTree::Transient tree{};
+    for (uint32_t i = 0; i < 100000; ++i) {
+        tree.push_back(i);
+    }
+    ASSERT_THROW(tree.parallel_for_each([](uint32_t v) {
+        if (v == 54321) {
+            throw std::runtime_error("failed");
+        }
+    }, pool), std::runtime_error);
+    // the pool still works afterwards
+    ASSERT_EQ(tree.parallel_reduce(uint64_t(0), std::plus<>(), pool), uint64_t(99999) * 100000 / 2);
+}
+
+using IndexedMap = BppTreeMap<uint32_t, uint32_t>::mixins<IndexedBuilder<>, ParallelBuilder>;
+
+template <DuplicatePolicy duplicate_policy, typename Executor>
+void check_build_parallel(std::vector<std::pair<uint32_t, uint32_t>> const& input, Executor&& executor) {
+    IndexedMap::Transient built{};
+    built.insert_or_assign(12345678u, 1u);
+    built.build_parallel<duplicate_policy>(input.begin(), input.end(), executor);
+    // the same contents built one insert at a time. with DuplicatePolicy::insert the pairs of each key stay in the
+    // order they had in input
+    std::vector<std::pair<uint32_t, uint32_t>> expected(input);
+    std::stable_sort(expected.begin(), expected.end(), [](auto const& a, auto const& b) { return a.first < b.first; });
+    if constexpr (duplicate_policy == DuplicatePolicy::ignore) {
+        expected.erase(std::unique(expected.begin(), expected.end(),
+                [](auto const& a, auto const& b) { return a.first == b.first; }), expected.end());
+    } else if constexpr (duplicate_policy == DuplicatePolicy::replace) {
+        IndexedMap::Transient inserted{};
+        for (auto const& pair : input) {
+            inserted.insert_or_assign(pair);
+        }
+        expected.assign(inserted.cbegin(), inserted.cend());
+    }
+    ASSERT_EQ(built.size(), expected.size());
+    size_t i = 0;
+    for (auto const& pair : std::as_const(built)) {
+        ASSERT_EQ(pair.first, expected[i].first);
+        ASSERT_EQ(pair.second, expected[i].second);
+        ++i;
+    }
+    for (size_t j = 0; j < expected.size(); j += 997) {
+        ASSERT_EQ(built.at_index(j).second, expected[j].second);
+        ASSERT_EQ(built.order(built.find_index(j)), j);
+    }
+    // the built tree can be modified like any other
+    if constexpr (duplicate_policy != DuplicatePolicy::insert) {
+        auto count = static_cast<uint32_t>(std::min(expected.size(), size_t(1000)));
+        for (uint32_t key = 0; key < count; ++key) {
+            built.insert_or_assign(key * 2 + 1000000, key);
+            built.erase_key(expected[key].first);
+        }
+        ASSERT_EQ(built.size(), expected.size());
+        for (uint32_t key = 0; key < count; ++key) {
+            ASSERT_EQ(built.at_key(key * 2 + 1000000), key);
+        }
+    }
+}
+
+TEST(BppTreeTest, TestBuildParallel) {
+    ThreadPool pool(4);
+    auto inline_executor = [](std::function<void()> const& task) { task(); };
+    std::vector<std::pair<uint32_t, uint32_t>> input{};
+    for (uint32_t i = 0; i < 300000; ++i) {
+        input.emplace_back(static_cast<uint32_t>(rand()) % 200000, i);
+    }
+    check_build_parallel<DuplicatePolicy::replace>(input, pool);
+    check_build_parallel<DuplicatePolicy::ignore>(input, pool);
+    check_build_parallel<DuplicatePolicy::insert>(input, pool);
+    check_build_parallel<DuplicatePolicy::replace>(input, inline_executor);
+    check_build_parallel<DuplicatePolicy::ignore>(input, inline_executor);
+    for (size_t size : {0u, 1u, 2u, 100u, 5000u}) {
+        std::vector<std::pair<uint32_t, uint32_t>> small(input.begin(), input.begin() + static_cast<ssize>(size));
+        check_build_parallel<DuplicatePolicy::replace>(small, pool);
+        check_build_parallel<DuplicatePolicy::ignore>(small, pool);
+    }
+    // 3 threads sort in 4 parts, which take an even number of merge rounds and end up in the buffer
+    ThreadPool two(2);
+    check_build_parallel<DuplicatePolicy::insert>(input, two);
+    check_build_parallel<DuplicatePolicy::ignore>(input, two);
+    // values that can't be copied in parallel are copied first
+    std::list<std::pair<uint32_t, uint32_t>> listed(input.begin(), input.end());
+    IndexedMap::Transient from_list{};
+    from_list.build_parallel(listed.begin(), listed.end(), pool);
+    IndexedMap::Transient from_vector{};
+    from_vector.build_parallel(input.begin(), input.end(), pool);
+    ASSERT_TRUE(std::equal(from_list.cbegin(), from_list.cend(), from_vector.cbegin(), from_vector.cend()));
+
+    // assign_sorted builds a tree from values that are already in order
+    ParallelIndexedTree::Transient tree{};
+    std::vector<uint32_t> sorted{};
+    for (uint32_t i = 0; i < 1000000; ++i) {
+        sorted.push_back(i * 3);
+    }
+    tree.assign_sorted(sorted.begin(), sorted.end());
+    ASSERT_EQ(tree.size(), sorted.size());
+    ASSERT_EQ(tree.parallel_reduce(uint64_t(0), std::plus<>(), pool), uint64_t(999999) * 1000000 / 2 * 3);
+    ASSERT_EQ(tree.at_index(123456), 123456u * 3);
+
+    // a tree that can hold exactly max_size() values, which is one level of internal nodes
+    using ShallowTree = BppTree<uint32_t, 512, 128, 2>::mixins<IndexedBuilder<>>;
+    ShallowTree::Transient shallow{};
+    sorted.resize(shallow.max_size());
+    shallow.assign_sorted(sorted.begin(), sorted.end());
+    ASSERT_EQ(shallow.size(), sorted.size());
+    ASSERT_EQ(shallow.depth(), 2u);
+    ASSERT_EQ(shallow.at_index(sorted.size() - 1), sorted.back());
+    sorted.push_back(sorted.back() + 3);
+    ASSERT_THROW(shallow.assign_sorted(sorted.begin(), sorted.end()), std::logic_error);
+    ASSERT_THROW(shallow.assign_parts(1, [&sorted](size_t, auto const& emit) {
+        for (uint32_t value : sorted) {
+            emit(value);
+        }
+    }, [](size_t count, auto const& body) { body(0, count); }), std::logic_error);
+    // the tree is unchanged
+    ASSERT_EQ(shallow.size(), sorted.size() - 1);
+    ASSERT_EQ(shallow.at_index(sorted.size() - 2), sorted[sorted.size() - 2]);
+}
+
+template <DuplicatePolicy duplicate_policy, typename Executor>
+void check_merge(std::vector<std::vector<std::pair<uint32_t, uint32_t>>> const& inputs, Executor&& executor) {
+    std::vector<IndexedMap::Transient> trees(inputs.size());
+    // the pairs of all trees ordered by key, with the pairs of each key in the order of the trees
+    std::vector<std::pair<uint32_t, uint32_t>> all{};
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        for (auto const& pair : inputs[i]) {
+            trees[i].insert_or_assign(pair);
+        }
+        all.insert(all.end(), std::as_const(trees[i]).begin(), std::as_const(trees[i]).end());
+    }
+    std::stable_sort(all.begin(), all.end(), [](auto const& a, auto const& b) { return a.first < b.first; });
+    std::vector<std::pair<uint32_t, uint32_t>> expected{};
+    for (size_t i = 0; i < all.size(); ++i) {
+        bool first_of_key = i == 0 || all[i - 1].first != all[i].first;
+        bool last_of_key = i + 1 == all.size() || all[i + 1].first != all[i].first;
+        if (duplicate_policy == DuplicatePolicy::insert ||
+                (duplicate_policy == DuplicatePolicy::ignore && first_of_key) ||
+                (duplicate_policy == DuplicatePolicy::replace && last_of_key)) {
+            expected.push_back(all[i]);
+        }
+    }
+    auto first = trees[0].persistent();
+    IndexedMap::Transient merged = first.transient();
+    if (trees.size() == 3) {
+        merged.merge_with<duplicate_policy>(executor, trees[1], trees[2].persistent());
+    } else {
+        merged.merge_with<duplicate_policy>(executor, trees[1]);
+    }
+    ASSERT_EQ(merged.size(), expected.size());
+    size_t i = 0;
+    for (auto const& pair : std::as_const(merged)) {
+        ASSERT_EQ(pair.first, expected[i].first);
+        ASSERT_EQ(pair.second, expected[i].second);
+        ++i;
+    }
+    for (size_t j = 0; j < expected.size(); j += 997) {
+        ASSERT_EQ(merged.at_index(j).second, expected[j].second);
+        ASSERT_EQ(merged.order(merged.find_index(j)), j);
+    }
+    // the merged tree can be modified without changing the trees it was merged from
+    for (uint32_t key = 0; key < 1000; ++key) {
+        merged.insert_or_assign(key * 7, 12345u);
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> after{};
+    for (auto const& tree : trees) {
+        after.insert(after.end(), std::as_const(tree).begin(), std::as_const(tree).end());
+    }
+    std::stable_sort(after.begin(), after.end(), [](auto const& a, auto const& b) { return a.first < b.first; });
+    ASSERT_TRUE(after == all);
+    ASSERT_EQ(first.size(), trees[0].size());
+}
+
+TEST(BppTreeTest, TestMerge) {
+    ThreadPool pool(4);
+    auto inline_executor = [](std::function<void()> const& task) { task(); };
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> overlapping(3);
+    for (uint32_t i = 0; i < 300000; ++i) {
+        auto& input = overlapping[i % 3];
+        input.emplace_back(static_cast<uint32_t>(rand()) % 200000 * 3 + i % 2, i);
+    }
+    check_merge<DuplicatePolicy::replace>(overlapping, pool);
+    check_merge<DuplicatePolicy::ignore>(overlapping, pool);
+    check_merge<DuplicatePolicy::insert>(overlapping, pool);
+    check_merge<DuplicatePolicy::replace>(overlapping, inline_executor);
+
+    // disjoint key ranges, out of order and of different depths, are linked together without copying values
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> disjoint(3);
+    for (uint32_t i = 0; i < 200000; ++i) {
+        disjoint[1].emplace_back(i, i);
+    }
+    for (uint32_t i = 0; i < 100; ++i) {
+        disjoint[2].emplace_back(i + 1000000, i);
+        disjoint[0].emplace_back(i + 500000, i);
+    }
+    check_merge<DuplicatePolicy::replace>(disjoint, pool);
+    check_merge<DuplicatePolicy::insert>(disjoint, inline_executor);
+    disjoint[1].clear();
+    check_merge<DuplicatePolicy::replace>(disjoint, pool);
+    disjoint[0].clear();
+    disjoint[2].clear();
+    check_merge<DuplicatePolicy::replace>(disjoint, pool);
+
+    // two trees that overlap and one that doesn't, which is joined in whole while the other two are merged
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> mixed(3);
+    for (uint32_t i = 0; i < 100000; ++i) {
+        mixed[0].emplace_back(i * 2, i);
+        mixed[1].emplace_back(i + 1000000, i);
+        mixed[2].emplace_back(i * 3, i + 1);
+    }
+    check_merge<DuplicatePolicy::replace>(mixed, pool);
+    check_merge<DuplicatePolicy::ignore>(mixed, inline_executor);
+    check_merge<DuplicatePolicy::insert>(mixed, pool);
+    mixed[1].resize(10);
+    check_merge<DuplicatePolicy::replace>(mixed, pool);
+
+    // small trees that overlap
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> small{{{1u, 1u}, {5u, 1u}}, {{5u, 2u}}};
+    check_merge<DuplicatePolicy::replace>(small, pool);
+    check_merge<DuplicatePolicy::ignore>(small, pool);
+    check_merge<DuplicatePolicy::insert>(small, pool);
+}
+
+template <typename Tree>
+void check_concatenated(std::vector<uint32_t> const& sizes) {
+    std::vector<typename Tree::Persistent> trees{};
+    uint32_t next = 0;
+    for (uint32_t size : sizes) {
+        typename Tree::Transient tree{};
+        for (uint32_t i = 0; i < size; ++i) {
+            tree.push_back(next++);
+        }
+        trees.push_back(tree.persistent());
+    }
+    typename Tree::Transient concatenated{};
+    concatenated.push_back(12345678u);
+    concatenated.assign_concatenated(trees);
+    ASSERT_EQ(concatenated.size(), next);
+    uint32_t expected = 0;
+    for (auto value : std::as_const(concatenated)) {
+        ASSERT_EQ(value, expected++);
+    }
+    for (uint32_t i = 0; i < next; i += 97) {
+        ASSERT_EQ(concatenated.at_index(i), i);
+        ASSERT_EQ(concatenated.order(concatenated.find_index(i)), i);
+    }
+    // the concatenated tree can be modified without changing the trees it shares nodes with
+    for (uint32_t i = 0; i < next; i += 3) {
+        concatenated.assign(concatenated.find_index(i), i + 1);
+    }
+    if (concatenated.depth() < concatenated.max_depth()) {
+        concatenated.insert_index(0, 0u);
+        concatenated.erase_index(concatenated.size() - 1);
+        ASSERT_EQ(concatenated.size(), next);
+    }
+    next = 0;
+    for (auto const& tree : trees) {
+        for (auto value : tree) {
+            ASSERT_EQ(value, next++);
+        }
+    }
+}
+
+TEST(BppTreeTest, TestAssignConcatenated) {
+    // trees of different depths in every order, each joined in at the level of its root
+    using Tree = BppTree<uint32_t, 64, 128>::mixins<IndexedBuilder<>>;
+    check_concatenated<Tree>({});
+    check_concatenated<Tree>({0, 0});
+    check_concatenated<Tree>({100000});
+    check_concatenated<Tree>({1, 100000, 1, 2000, 0, 5, 100000, 10, 30000, 1});
+    check_concatenated<Tree>({100000, 1000, 10, 1});
+    check_concatenated<Tree>({1, 10, 1000, 100000});
+    check_concatenated<Tree>(std::vector<uint32_t>(1000, 20));
+    Tree::Transient tall{};
+    std::vector<Tree::Persistent> trees{};
+    for (uint32_t i = 0; i < 100000; ++i) {
+        tall.push_back(i);
+    }
+    trees.push_back(tall.persistent());
+    size_t depth = tall.depth();
+    for (uint32_t i = 0; i < 1000; ++i) {
+        Tree::Transient leaf{};
+        leaf.push_back(i + 100000);
+        trees.push_back(leaf.persistent());
+    }
+    tall.assign_concatenated(trees);
+    ASSERT_EQ(tall.size(), 101000);
+    ASSERT_LE(tall.depth(), depth + 1);
+    // joining trees of the maximum depth needs one level more, so the leaves are repacked instead
+    using ShallowTree = BppTree<uint32_t, 64, 128, 2>::mixins<IndexedBuilder<>>;
+    check_concatenated<ShallowTree>({15, 20, 1, 15});
+}
@@ -0,0 +1,148 @@
+#include <map>
+#include "gtest/gtest.h"
+#include "test_common.hpp"
+#include "bpptree/min.hpp"
+#include "bpptree/radix_partitioned.hpp"
+
+using namespace std;
+
+static constexpr auto same_pair = [](auto const& a, auto const& b) {
+    return a.first == b.first && a.second == b.second;
+};
+
+TEST(BppTreeTest, TestRadixPartitioned) {
+    static constexpr int n = 100*1000;
+    Vector<int32_t> const& rand_ints = RandInts<int32_t, n>::ints;
+
+    using TreeType = BppTreeMap<int32_t, int64_t>::mixins<
+            IndexedBuilder<>,
+            SummedBuilder<PairExtractor<1>>,
+            MinBuilder<>::extractor<PairExtractor<1>>>;
+    using Partitioned = RadixPartitioned<int32_t, TreeType, 4>;
+    Partitioned::Transient tree{};
+    std::map<int32_t, int64_t> expected{};
+    EXPECT_TRUE(tree.empty());
+    for (int32_t i : rand_ints) {
+        // spread keys over negative and positive values so every partition is used
+        int32_t key = static_cast<int32_t>(static_cast<uint32_t>(i) * 2654435761u);
+        tree.insert_or_assign(key, i % 1000);
+        expected[key] = i % 1000;
+    }
+    EXPECT_EQ(tree.size(), expected.size());
+    EXPECT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end(), same_pair));
+    int64_t sum = 0;
+    int64_t min = std::numeric_limits<int64_t>::max();
+    for (auto const& [k, v] : expected) {
+        sum += v;
+        min = std::min(min, v);
+    }
+    EXPECT_EQ(tree.sum(), sum);
+    EXPECT_EQ(tree.min(), min);
+
+    size_t index = 0;
+    for (auto it = expected.begin(); it != expected.end(); ++it, ++index) {
+        if (index % 97 != 0) continue;
+        auto found = tree.find(it->first);
+        ASSERT_TRUE(found != tree.end());
+        EXPECT_TRUE(same_pair(*found, *it));
+        EXPECT_EQ(tree.order(found), index);
+        EXPECT_TRUE(same_pair(tree.at_index(index), *it));
+        EXPECT_EQ(tree.at_key(it->first), it->second);
+        EXPECT_TRUE(tree.contains(it->first));
+        EXPECT_TRUE(same_pair(*tree.lower_bound(it->first), *it));
+        auto next = std::next(it);
+        if (next == expected.end()) {
+            EXPECT_TRUE(tree.upper_bound(it->first) == tree.end());
+        } else {
+            EXPECT_TRUE(same_pair(*tree.upper_bound(it->first), *next));
+        }
+    }
+
+    auto rit = tree.end();
+    for (auto eit = expected.rbegin(); eit != expected.rend(); ++eit) {
+        --rit;
+        ASSERT_TRUE(same_pair(*rit, *eit));
+    }
+    EXPECT_TRUE(rit == tree.begin());
+
+    Partitioned::Persistent persistent = tree.persistent();
+    std::map<int32_t, int64_t> const snapshot = expected;
+    for (auto it = expected.begin(); it != expected.end();) {
+        tree.erase_key(it->first);
+        it = expected.erase(it);
+        if (it != expected.end()) ++it;
+    }
+    EXPECT_EQ(tree.size(), expected.size());
+    EXPECT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end(), same_pair));
+    EXPECT_TRUE(std::equal(persistent.begin(), persistent.end(), snapshot.begin(), snapshot.end(), same_pair));
+
+    Partitioned::Persistent modified = persistent.insert_or_assign(std::numeric_limits<int32_t>::min(), int64_t{-1});
+    EXPECT_EQ(modified.size(), persistent.size() + (persistent.contains(std::numeric_limits<int32_t>::min()) ? 0 : 1));
+    EXPECT_EQ(modified.begin()->first, std::numeric_limits<int32_t>::min());
+    EXPECT_EQ(modified.min(), -1);
+    EXPECT_EQ(modified.erase_key(std::numeric_limits<int32_t>::min()).min(), persistent.min());
+
+    tree.clear();
+    EXPECT_TRUE(tree.empty());
+    EXPECT_TRUE(tree.begin() == tree.end());
+}
+
+TEST(BppTreeTest, TestRadixPartitionedSparse) {
+    using TreeType = BppTreeMap<int32_t, int64_t>::mixins<IndexedBuilder<>>;
+    using Partitioned = RadixPartitioned<int32_t, TreeType, 16>;
+    Partitioned::Transient tree{};
+    EXPECT_TRUE(tree.empty());
+    EXPECT_TRUE(tree.begin() == tree.end());
+    EXPECT_THROW(static_cast<void>(tree.at_index(0)), std::out_of_range);
+
+    // keys land in partitions 0, 1 and 65535 only
+    std::map<int32_t, int64_t> expected{};
+    for (int32_t i = 0; i < 1000; ++i) {
+        for (int32_t key : {std::numeric_limits<int32_t>::min() + i, std::numeric_limits<int32_t>::min() + 65536 + i, std::numeric_limits<int32_t>::max() - i}) {
+            tree.insert_or_assign(key, int64_t{i});
+            expected[key] = i;
+        }
+    }
+    EXPECT_EQ(tree.size(), expected.size());
+    EXPECT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end(), same_pair));
+    EXPECT_TRUE(same_pair(tree.at_index(expected.size() - 1), *expected.rbegin()));
+    EXPECT_THROW(static_cast<void>(tree.at_index(expected.size())), std::out_of_range);
+    EXPECT_TRUE(tree.lower_bound(0) == tree.find(std::numeric_limits<int32_t>::max() - 999));
+
+    // a copy shares chunks with the original until one of them writes
+    Partitioned::Transient copy = tree;
+    copy.erase_key(std::numeric_limits<int32_t>::min());
+    copy.insert_or_assign(0, int64_t{-1});
+    EXPECT_EQ(tree.size(), expected.size());
+    EXPECT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end(), same_pair));
+    EXPECT_EQ(copy.size(), expected.size());
+    EXPECT_FALSE(copy.contains(std::numeric_limits<int32_t>::min()));
+    EXPECT_EQ(copy.at_key(0), -1);
+
+    // persistent modifications leave every other version unchanged
+    Partitioned::Persistent persistent = tree.persistent();
+    Partitioned::Persistent modified = persistent.insert_or_assign(0, int64_t{-2}).erase_key(std::numeric_limits<int32_t>::max());
+    EXPECT_TRUE(std::equal(persistent.begin(), persistent.end(), expected.begin(), expected.end(), same_pair));
+    EXPECT_EQ(modified.size(), expected.size());
+    EXPECT_EQ(modified.at_key(0), -2);
+    EXPECT_FALSE(modified.contains(std::numeric_limits<int32_t>::max()));
+    Partitioned::Transient back = modified.transient();
+    back.insert_or_assign(std::numeric_limits<int32_t>::max(), int64_t{7});
+    EXPECT_EQ(back.at_key(std::numeric_limits<int32_t>::max()), 7);
+    EXPECT_FALSE(modified.contains(std::numeric_limits<int32_t>::max()));
+    EXPECT_EQ(persistent.at_key(std::numeric_limits<int32_t>::max()), 0);
+
+    // erasing an absent key changes nothing, and direct modifications of the latest partition handed out are counted
+    copy.erase_key(12345);
+    EXPECT_EQ(copy.size(), expected.size());
+    EXPECT_EQ(modified.erase_key(12345).size(), modified.size());
+    copy.partition(5).insert_or_assign(5, int64_t{5});
+    EXPECT_EQ(copy.size(), expected.size() + 1);
+    copy.partition(std::numeric_limits<int32_t>::min()).erase_key(std::numeric_limits<int32_t>::min() + 1);
+    EXPECT_EQ(copy.size(), expected.size());
+    EXPECT_EQ(copy.persistent().size(), expected.size());
+    EXPECT_EQ(copy.persistent().transient().size(), expected.size());
+    copy.clear();
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(tree.size(), expected.size());
+}
@@ -59,3 +59,38 @@ TEST(BppTreeTest, TestPersistentRandomModificationsIndexed) {
     }
     EXPECT_TRUE(std::equal(vec.begin(), vec.end(), tree.begin(), tree.end()));
 }
+
+template <typename T, typename F>
+static void test_transient_random_modifications_indexed(F const& make_value) {
+    size_t n = 200*1000;
+    using TreeType = typename BppTree<T, 512, 512, 6>::template mixins<IndexedBuilder<>>;
+    typename TreeType::Transient tree{};
+    typename TreeType::Persistent snapshot{};
+    std::vector<T> vec{};
+    for (size_t i = 0; i < n; ++i) {
+        double d = static_cast<double>(rand())/RAND_MAX;
+        size_t index = static_cast<size_t>(rand()) % (tree.size() + 1);
+        auto vec_it = vec.begin() + signed_cast(index);
+        if (tree.size() == 0 || index == tree.size() || d < 0.5) {
+            tree.insert_index(index, make_value(i));
+            vec.insert(vec_it, make_value(i));
+        } else if (d < 0.6) {
+            tree.assign_index(index, make_value(i));
+            *vec_it = make_value(i);
+        } else {
+            tree.erase_index(index);
+            vec.erase(vec_it);
+        }
+        if (i % 10000 == 0) {
+            // sharing every node with a snapshot makes the following modifications copy nodes instead of shifting
+            // values in place
+            snapshot = tree.persistent();
+        }
+    }
+    EXPECT_TRUE(std::equal(vec.begin(), vec.end(), tree.cbegin(), tree.cend()));
+}
+
+TEST(BppTreeTest, TestTransientRandomModificationsIndexed) {
+    test_transient_random_modifications_indexed<size_t>([](size_t i) { return i; });
+    test_transient_random_modifications_indexed<std::string>([](size_t i) { return std::to_string(i); });
+}
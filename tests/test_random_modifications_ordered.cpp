@@ -120,3 +120,89 @@ TEST(BppTreeTest, TestTransientRandomModificationsOrdered) {
             tree.cend(),
             [](auto const& a, auto const& b){ return a.first == std::get<0>(b) && a.second == std::get<1>(b); }));
 }
+
+TEST(BppTreeTest, TestWriteBufferRandomModificationsOrdered) {
+    size_t n = 1000*1000;
+    using TreeType = BppTree<std::pair<size_t, size_t>, 512, 512, 5>::mixins<OrderedBuilder<>, SummedBuilder<PairExtractor<1>>>::Transient;
+    TreeType tree{};
+    std::map<size_t, size_t> map{};
+    {
+        auto buffer = tree.write_buffer(100);
+        for (size_t i = 0; i < n; ++i) {
+            double d = static_cast<double>(rand())/RAND_MAX;
+            auto r = static_cast<size_t>(rand()) % 100000;
+            if (d < 0.6) {
+                buffer.insert_or_assign(r, i);
+                map[r] = i;
+            } else if (d < 0.8) {
+                buffer.erase_key(r);
+                map.erase(r);
+            } else {
+                ASSERT_EQ(map.count(r) > 0, buffer.contains(r));
+                if (map.count(r) > 0) {
+                    ASSERT_EQ(map[r], buffer.at_key(r));
+                }
+            }
+            if (i % 100000 == 0) {
+                buffer.flush();
+                ASSERT_EQ(0u, buffer.pending());
+                ASSERT_EQ(map.size(), tree.size());
+            }
+        }
+    }
+    size_t sum = 0;
+    for (auto const& p : map) {
+        sum += p.second;
+    }
+    EXPECT_EQ(sum, tree.sum());
+    EXPECT_TRUE(std::equal(
+            map.cbegin(),
+            map.cend(),
+            tree.cbegin(),
+            tree.cend(),
+            [](auto const& a, auto const& b){ return a.first == b.first && a.second == b.second; }));
+}
+
+TEST(BppTreeTest, TestWriteBufferRebuild) {
+    using TreeType = BppTree<std::pair<size_t, size_t>, 512, 512, 5>::mixins<OrderedBuilder<>, SummedBuilder<PairExtractor<1>>>::Transient;
+    TreeType tree{};
+    std::map<size_t, size_t> map{};
+    for (size_t i = 0; i < 10000; i += 2) {
+        tree.insert_or_assign(i, i);
+        map[i] = i;
+    }
+    auto snapshot = tree.persistent();
+    std::map<size_t, size_t> const snapshot_map = map;
+    // enough writes to the same keys that the flush rebuilds the tree, with several writes to most keys
+    auto buffer = tree.write_buffer(100000);
+    for (size_t i = 0; i < 20000; ++i) {
+        size_t r = static_cast<size_t>(rand()) % 12000;
+        if (i % 3 == 0) {
+            buffer.erase_key(r);
+            map.erase(r);
+        } else {
+            buffer.insert_or_assign(r, i);
+            map[r] = i;
+        }
+        if (i % 7 == 0) {
+            size_t key = static_cast<size_t>(rand()) % 12000;
+            ASSERT_EQ(map.count(key) > 0, buffer.contains(key));
+            if (map.count(key) > 0) {
+                ASSERT_EQ(map[key], buffer.at_key(key));
+            }
+        }
+    }
+    EXPECT_EQ(20000u, buffer.pending());
+    buffer.flush();
+    EXPECT_EQ(0u, buffer.pending());
+    EXPECT_EQ(map.size(), tree.size());
+    size_t sum = 0;
+    for (auto const& p : map) {
+        sum += p.second;
+    }
+    EXPECT_EQ(sum, tree.sum());
+    EXPECT_TRUE(std::equal(map.cbegin(), map.cend(), tree.cbegin(), tree.cend(),
+            [](auto const& a, auto const& b){ return a.first == b.first && a.second == b.second; }));
+    EXPECT_TRUE(std::equal(snapshot_map.cbegin(), snapshot_map.cend(), snapshot.cbegin(), snapshot.cend(),
+            [](auto const& a, auto const& b){ return a.first == b.first && a.second == b.second; }));
+}
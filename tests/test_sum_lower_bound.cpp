@@ -22,3 +22,36 @@ TEST(BppTreeTest, TestSumLowerBound) {
     }
     EXPECT_EQ(sum, tree.sum_exclusive(tree.end()));
 }
+
+template <typename T>
+void test_sum_lower_bound_random() {
+    static constexpr int n = 10*1000;
+    Vector<int32_t> const& rand_ints = RandInts<int32_t, n>::ints;
+    using TreeType = typename BppTree<T, 512, 512, 4>::template mixins<SummedBuilder<>, IndexedBuilder<>>::Transient;
+    TreeType tree{};
+    std::vector<T> prefix{};
+    T sum{};
+    for (int32_t i : rand_ints) {
+        // weights of zero mean several elements share a prefix sum, sum_lower_bound must return the first of them
+        T weight = static_cast<T>(i % 4) / static_cast<T>(2);
+        tree.push_back(weight);
+        sum += weight;
+        prefix.push_back(sum);
+    }
+    for (size_t i = 0; i < prefix.size(); i += 7) {
+        for (T delta : {static_cast<T>(0), static_cast<T>(1)}) {
+            T target = prefix[i] - delta;
+            auto expected = std::lower_bound(prefix.begin(), prefix.end(), target) - prefix.begin();
+            EXPECT_EQ(tree.sum_lower_bound(target) - tree.begin(), expected);
+        }
+    }
+    EXPECT_EQ(tree.sum_lower_bound(sum + 1), tree.end());
+}
+
+TEST(BppTreeTest, TestSumLowerBoundRandomInt) {
+    test_sum_lower_bound_random<int64_t>();
+}
+
+TEST(BppTreeTest, TestSumLowerBoundRandomDouble) {
+    test_sum_lower_bound_random<double>();
+}